@@ -27,6 +27,8 @@ public class DynamicProperties : ModuleRules
 			{
 				"Core",
 				"GameplayTags",
+				"StructUtils",
+				"NetCore",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
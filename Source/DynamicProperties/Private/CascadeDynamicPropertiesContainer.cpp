@@ -1,23 +1,132 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CascadeDynamicPropertiesContainer.h"
+#include "DynamicPropertiesStats.h"
 
 UCascadeDynamicPropertiesContainer::UCascadeDynamicPropertiesContainer()
 {
 }
 
+void UCascadeDynamicPropertiesContainer::PostLoad()
+{
+	Super::PostLoad();
+
+	// Loaded properties were never added through OnPropertyAddedInternal
+	RebuildHierarchyIndex();
+}
+
+SIZE_T UCascadeDynamicPropertiesContainer::GetAllocatedSize() const
+{
+	SIZE_T Size = Super::GetAllocatedSize()
+		+ ParentPropertyTags.GetAllocatedSize()
+		+ ChildPropertyTags.GetAllocatedSize()
+		+ ResolvedAncestorTags.GetAllocatedSize();
+
+	for (const TPair<FGameplayTag, TArray<FGameplayTag>>& Pair : ChildPropertyTags)
+	{
+		Size += Pair.Value.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+void UCascadeDynamicPropertiesContainer::OnPropertiesRestoredInternal()
+{
+	RebuildHierarchyIndex();
+
+	Super::OnPropertiesRestoredInternal();
+}
+
+void UCascadeDynamicPropertiesContainer::OnPropertiesInitializedInternal(const TArray<FGameplayTag>& AddedTags)
+{
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_CascadeUpdate);
+
+	// Added tags come parents first, so each one is indexed below its final parent with few adoptions
+	for (const FGameplayTag& PropertyTag : AddedTags)
+	{
+		AddToHierarchyIndex(PropertyTag);
+	}
+
+	// One breadth-first pass re-bases the added properties and every property below one whose value was set,
+	// as adding them one at a time would have, but visiting each property once
+	TSet<FGameplayTag> RebasedTags(AddedTags);
+	TArray<FCascadeValueChange, TInlineAllocator<16>> ExistingChanges;
+
+	TArray<FGameplayTag> OrderedTags;
+	GetPropertiesInUpdateOrder(OrderedTags);
+	DYNAMIC_PROPERTIES_COUNT(CascadeNodesVisited, this, FGameplayTag(), OrderedTags.Num());
+
+	for (const FGameplayTag& PropertyTag : OrderedTags)
+	{
+		const FGameplayTag ParentTag = ParentPropertyTags.FindRef(PropertyTag);
+		if (!ParentTag.IsValid() || !(RebasedTags.Contains(PropertyTag) || RebasedTags.Contains(ParentTag)))
+		{
+			continue;
+		}
+
+		float ParentValue = 0.0f;
+		float OldValue = 0.0f;
+		float NewValue = 0.0f;
+		if (!FindPropertyValue(ParentTag, ParentValue) || !SetPropertyBaseValueSilently(PropertyTag, ParentValue, OldValue, NewValue))
+		{
+			continue;
+		}
+
+		bool bIsAddedProperty = false;
+		RebasedTags.Add(PropertyTag, &bIsAddedProperty);
+
+		// Added properties have no listeners that saw their preset value
+		if (!bIsAddedProperty)
+		{
+			ExistingChanges.Add({ PropertyTag, OldValue, NewValue });
+		}
+	}
+
+	// Existing properties report their change as usual, parents before children
+	for (const FCascadeValueChange& Change : ExistingChanges)
+	{
+		Super::OnPropertyValueChangedInternal(Change.PropertyTag, Change.OldValue, Change.NewValue);
+		BroadcastPropertyValueChanged(Change.PropertyTag, Change.OldValue, Change.NewValue);
+	}
+
+	Super::OnPropertiesInitializedInternal(AddedTags);
+}
+
+void UCascadeDynamicPropertiesContainer::RebuildHierarchyIndex()
+{
+	ParentPropertyTags.Reset();
+	ChildPropertyTags.Reset();
+	ResolvedAncestorTags.Reset();
+
+	TArray<FGameplayTag> PropertyTags;
+	GetPropertiesKeys(PropertyTags);
+	for (const FGameplayTag& PropertyTag : PropertyTags)
+	{
+		AddToHierarchyIndex(PropertyTag);
+	}
+}
+
 float UCascadeDynamicPropertiesContainer::GetPropertyValueOrDefault(FGameplayTag PropertyTag, float DefaultValue)
 {
+	float Value = DefaultValue;
+
+	// Tags queried before without a property of their own already know which ancestor resolves them
+	if (const FGameplayTag* ResolvedTag = ResolvedAncestorTags.Find(PropertyTag))
+	{
+		return ResolvedTag->IsValid() && FindPropertyValue(*ResolvedTag, Value) ? Value : DefaultValue;
+	}
+
 	// If the property exists, return its calculated value
-	if (UDynamicProperty* Property = GetProperty(PropertyTag))
+	if (FindPropertyValue(PropertyTag, Value))
 	{
-		return Property->GetValue();
+		return Value;
 	}
 
 	// If property doesn't exist, walk up hierarchy to find a parent and calculate from there
-	if (UDynamicProperty* ParentProperty = FindNearestParentProperty(PropertyTag))
+	const FGameplayTag ParentTag = FindNearestParentPropertyTag(PropertyTag);
+	if (ParentTag.IsValid() && FindPropertyValue(ParentTag, Value))
 	{
-		return ParentProperty->GetValue();
+		return Value;
 	}
 
 	// No properties in hierarchy found, return default
@@ -26,204 +135,277 @@ float UCascadeDynamicPropertiesContainer::GetPropertyValueOrDefault(FGameplayTag
 
 void UCascadeDynamicPropertiesContainer::OnPropertyAddedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property)
 {
-	if (!Property)
-	{
-		return;
-	}
+	AddToHierarchyIndex(PropertyTag);
 
 	// When adding a new property, check if it should use a parent's value as base
-	if (UDynamicProperty* ParentProperty = FindNearestParentProperty(PropertyTag))
+	// Replicated values already include the cascade
+	float ParentValue = 0.0f;
+	const FGameplayTag ParentTag = IsApplyingReplicatedValues() ? FGameplayTag() : FindNearestParentPropertyTag(PropertyTag);
+	if (ParentTag.IsValid() && FindPropertyValue(ParentTag, ParentValue))
 	{
 		// Set the parent's current value as this property's base value
-		Property->SetBaseValue(ParentProperty->GetValue());
+		SetPropertyBaseValue(PropertyTag, ParentValue);
 	}
 
 	// Call parent implementation to fire the initial OnPropertyValueChanged event
 	Super::OnPropertyAddedInternal(PropertyTag, Property);
 }
 
+void UCascadeDynamicPropertiesContainer::OnPropertyRemovedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property)
+{
+	TArray<FGameplayTag> AdoptedChildren;
+	const FGameplayTag NewParentTag = RemoveFromHierarchyIndex(PropertyTag, AdoptedChildren);
+
+	// Children of the removed property now cascade from its nearest parent
+	float NewParentValue = 0.0f;
+	if (!IsApplyingReplicatedValues() && NewParentTag.IsValid() && FindPropertyValue(NewParentTag, NewParentValue))
+	{
+		for (const FGameplayTag& ChildTag : AdoptedChildren)
+		{
+			SetPropertyBaseValue(ChildTag, NewParentValue);
+		}
+	}
+
+	Super::OnPropertyRemovedInternal(PropertyTag, Property);
+}
+
 void UCascadeDynamicPropertiesContainer::OnPropertyValueChangedInternal(FGameplayTag PropertyTag, float OldValue, float NewValue)
 {
-	// When a property changes, update base values of all direct children
-	UpdateChildPropertiesBaseValue(PropertyTag, NewValue);
+	// When a property changes, update base values of its whole subtree before anyone is notified
+	// Replicated values already include the cascade, descendants receive their own
+	TArray<FCascadeValueChange, TInlineAllocator<16>> DescendantChanges;
+	if (!IsApplyingReplicatedValues())
+	{
+		UpdateChildPropertiesBaseValue(PropertyTag, NewValue, DescendantChanges);
+	}
 
 	// Call parent implementation to broadcast the event
 	Super::OnPropertyValueChangedInternal(PropertyTag, OldValue, NewValue);
+
+	// Then report the descendants, parents before children
+	for (const FCascadeValueChange& Change : DescendantChanges)
+	{
+		Super::OnPropertyValueChangedInternal(Change.PropertyTag, Change.OldValue, Change.NewValue);
+		BroadcastPropertyValueChanged(Change.PropertyTag, Change.OldValue, Change.NewValue);
+	}
 }
 
-void UCascadeDynamicPropertiesContainer::UpdateChildPropertiesBaseValue(FGameplayTag ParentTag, float NewParentValue)
+void UCascadeDynamicPropertiesContainer::GetPropertiesInUpdateOrder(TArray<FGameplayTag>& OutTags) const
 {
-	// Get all children that should be updated (direct and non-direct without intermediate nodes)
-	TArray<FGameplayTag> ChildrenToUpdate;
-	GetChildrenToUpdate(ParentTag, ChildrenToUpdate);
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_CascadeUpdateOrder);
+
+	OutTags.Reset(DynamicProperties.Num());
 
-	for (const FGameplayTag& ChildTag : ChildrenToUpdate)
+	// Breadth-first walk of the hierarchy index starting from the roots (stored under the empty tag)
+	if (const TArray<FGameplayTag>* RootTags = GetChildrenToUpdate(FGameplayTag()))
 	{
-		if (UDynamicProperty* ChildProperty = GetProperty(ChildTag))
+		OutTags.Append(*RootTags);
+	}
+
+	for (int32 i = 0; i < OutTags.Num(); ++i)
+	{
+		if (const TArray<FGameplayTag>* ChildTags = GetChildrenToUpdate(OutTags[i]))
 		{
-			// Setting base value will trigger recalculation and fire events, creating cascade
-			ChildProperty->SetBaseValue(NewParentValue);
+			OutTags.Append(*ChildTags);
 		}
 	}
 }
 
-UDynamicProperty* UCascadeDynamicPropertiesContainer::FindNearestParentProperty(FGameplayTag ChildTag)
+void UCascadeDynamicPropertiesContainer::OnPropertyDirtyInternal(FGameplayTag PropertyTag)
 {
-	// Get the tag as a string and split by dots
-	FString TagString = ChildTag.ToString();
-	TArray<FString> TagParts;
-	TagString.ParseIntoArray(TagParts, TEXT("."));
+	// Children take their base value from this property, so they are out of date as well
+	if (const TArray<FGameplayTag>* IndexedChildren = GetChildrenToUpdate(PropertyTag))
+	{
+		const TArray<FGameplayTag, TInlineAllocator<16>> ChildrenToMark(*IndexedChildren);
+		for (const FGameplayTag& ChildTag : ChildrenToMark)
+		{
+			MarkPropertyDirty(ChildTag);
+		}
+	}
 
-	// Walk up the hierarchy from immediate parent to root
-	for (int32 i = TagParts.Num() - 1; i > 0; --i)
+	Super::OnPropertyDirtyInternal(PropertyTag);
+}
+
+void UCascadeDynamicPropertiesContainer::FlushPropertyDependencies(FGameplayTag PropertyTag)
+{
+	// Recalculating the parent cascades its new value into this property's base value
+	if (UDynamicProperty* ParentProperty = FindPropertyObject(FindNearestParentPropertyTag(PropertyTag)))
 	{
-		// Build parent tag string
-		FString ParentTagString;
-		for (int32 j = 0; j < i; ++j)
+		ParentProperty->FlushPendingChanges();
+	}
+
+	Super::FlushPropertyDependencies(PropertyTag);
+}
+
+int32 UCascadeDynamicPropertiesContainer::PrecomputePendingValues()
+{
+	// Values predicted for this flush, used as base values of the children
+	TMap<FGameplayTag, float> PredictedValues;
+	int32 NumPrecomputed = 0;
+
+	TArray<FGameplayTag> OrderedTags;
+	GetPropertiesInUpdateOrder(OrderedTags);
+
+	for (const FGameplayTag& PropertyTag : OrderedTags)
+	{
+		UDynamicProperty* Property = FindPropertyObject(PropertyTag);
+		if (!Property || !Property->IsValueDirty())
 		{
-			if (j > 0)
-			{
-				ParentTagString += TEXT(".");
-			}
-			ParentTagString += TagParts[j];
+			continue;
 		}
 
-		// Try to get property with this parent tag
-		FGameplayTag ParentTag = FGameplayTag::RequestGameplayTag(FName(*ParentTagString), false);
-		if (ParentTag.IsValid())
+		// The cascade will only re-base this property if its parent's value actually changes
+		float BaseValue = Property->GetBaseValue();
+		const FGameplayTag* ParentTag = ParentPropertyTags.Find(PropertyTag);
+		const float* ParentPredictedValue = ParentTag ? PredictedValues.Find(*ParentTag) : nullptr;
+		if (ParentPredictedValue)
 		{
-			if (UDynamicProperty* ParentProperty = GetProperty(ParentTag))
+			const UDynamicProperty* ParentProperty = FindPropertyObject(*ParentTag);
+			if (ParentProperty && !FMath::IsNearlyEqual(ParentProperty->GetCachedValue(), *ParentPredictedValue))
 			{
-				return ParentProperty;
+				BaseValue = *ParentPredictedValue;
 			}
 		}
+
+		// A misprediction is harmless: the recalculation falls back to the regular path when base values differ
+		float PrecomputedValue = 0.0f;
+		if (Property->PrecomputeValue(BaseValue, PrecomputedValue))
+		{
+			PredictedValues.Add(PropertyTag, PrecomputedValue);
+			++NumPrecomputed;
+		}
 	}
 
-	return nullptr;
+	return NumPrecomputed;
 }
 
-void UCascadeDynamicPropertiesContainer::GetDirectChildTags(FGameplayTag ParentTag, TArray<FGameplayTag>& OutChildTags)
+void UCascadeDynamicPropertiesContainer::UpdateChildPropertiesBaseValue(FGameplayTag ParentTag, float NewParentValue, TArray<FCascadeValueChange, TInlineAllocator<16>>& OutChanges)
 {
-	OutChildTags.Empty();
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_CascadeUpdate);
 
-	FString ParentTagString = ParentTag.ToString();
-	int32 ParentDepth = GetTagDepth(ParentTagString);
+	OutChanges.Reset();
 
-	// Iterate through all properties to find direct children
-	TArray<FGameplayTag> AllKeys;
-	DynamicProperties.GetKeys(AllKeys);
+	// The changed parent acts as the first entry of the breadth-first queue, changed descendants are appended as they are visited
+	int32 QueueIndex = INDEX_NONE;
+	FGameplayTag CurrentTag = ParentTag;
+	float CurrentValue = NewParentValue;
 
-	for (const FGameplayTag& Tag : AllKeys)
+	while (true)
 	{
-		FString TagString = Tag.ToString();
-		
-		// Check if this tag starts with parent tag
-		if (TagString.StartsWith(ParentTagString + TEXT(".")))
+		// Get all children that should be updated (direct and non-direct without intermediate nodes)
+		// Nothing fires while the pass runs, so the index can't change under us
+		if (const TArray<FGameplayTag>* ChildrenToUpdate = GetChildrenToUpdate(CurrentTag))
 		{
-			// Count depth of this tag
-			int32 TagDepth = GetTagDepth(TagString);
+			DYNAMIC_PROPERTIES_COUNT(CascadeNodesVisited, this, CurrentTag, ChildrenToUpdate->Num());
 
-			// Only include direct children (one level deeper)
-			if (TagDepth == ParentDepth + 1)
+			for (const FGameplayTag& ChildTag : *ChildrenToUpdate)
 			{
-				OutChildTags.Add(Tag);
+				float ChildOldValue = 0.0f;
+				float ChildNewValue = 0.0f;
+				if (SetPropertyBaseValueSilently(ChildTag, CurrentValue, ChildOldValue, ChildNewValue))
+				{
+					OutChanges.Add({ ChildTag, ChildOldValue, ChildNewValue });
+				}
 			}
 		}
+
+		// Only descendants whose value changed have to pass it on
+		if (++QueueIndex >= OutChanges.Num())
+		{
+			break;
+		}
+
+		CurrentTag = OutChanges[QueueIndex].PropertyTag;
+		CurrentValue = OutChanges[QueueIndex].NewValue;
 	}
 }
 
-int32 UCascadeDynamicPropertiesContainer::GetTagDepth(const FString& TagString)
+FGameplayTag UCascadeDynamicPropertiesContainer::FindNearestParentPropertyTag(FGameplayTag ChildTag) const
 {
-	if (TagString.IsEmpty())
+	// Indexed properties already know their parent, other tags walk up the tag tree once
+	if (const FGameplayTag* IndexedParentTag = ParentPropertyTags.Find(ChildTag))
 	{
-		return 0;
+		return *IndexedParentTag;
 	}
 
-	// Count dots in the string - depth is dots + 1
-	int32 DotCount = 0;
-	for (int32 i = 0; i < TagString.Len(); ++i)
+	if (const FGameplayTag* ResolvedTag = ResolvedAncestorTags.Find(ChildTag))
 	{
-		if (TagString[i] == '.')
-		{
-			++DotCount;
-		}
+		return *ResolvedTag;
 	}
 
-	return DotCount + 1;
+	const FGameplayTag ParentTag = FindNearestParentTag(ChildTag);
+	ResolvedAncestorTags.Add(ChildTag, ParentTag);
+	return ParentTag;
 }
 
-void UCascadeDynamicPropertiesContainer::GetChildrenToUpdate(FGameplayTag ParentTag, TArray<FGameplayTag>& OutChildTags)
+FGameplayTag UCascadeDynamicPropertiesContainer::FindNearestParentTag(FGameplayTag ChildTag) const
 {
-	OutChildTags.Empty();
+	// Walk up the hierarchy from immediate parent to root
+	for (FGameplayTag ParentTag = ChildTag.RequestDirectParent(); ParentTag.IsValid(); ParentTag = ParentTag.RequestDirectParent())
+	{
+		if (HasProperty(ParentTag))
+		{
+			return ParentTag;
+		}
+	}
 
-	FString ParentTagString = ParentTag.ToString();
-	int32 ParentDepth = GetTagDepth(ParentTagString);
+	return FGameplayTag();
+}
 
-	// Use a set to prevent duplicates
-	TSet<FGameplayTag> UniqueChildTags;
+void UCascadeDynamicPropertiesContainer::AddToHierarchyIndex(FGameplayTag PropertyTag)
+{
+	ResolvedAncestorTags.Reset();
 
-	// Iterate through all properties to find children to update
-	TArray<FGameplayTag> AllKeys;
-	DynamicProperties.GetKeys(AllKeys);
+	const FGameplayTag ParentTag = FindNearestParentTag(PropertyTag);
+	ParentPropertyTags.Add(PropertyTag, ParentTag);
 
-	for (const FGameplayTag& Tag : AllKeys)
+	// Existing descendants of the new property were children of its parent until now
+	TArray<FGameplayTag> AdoptedChildren;
+	if (TArray<FGameplayTag>* SiblingTags = ChildPropertyTags.Find(ParentTag))
 	{
-		FString TagString = Tag.ToString();
-		
-		// Check if this tag starts with parent tag
-		if (TagString.StartsWith(ParentTagString + TEXT(".")))
+		for (int32 i = 0; i < SiblingTags->Num(); )
 		{
-			int32 TagDepth = GetTagDepth(TagString);
-
-			// Check if this is a direct child (exactly one level deeper)
-			if (TagDepth == ParentDepth + 1)
+			const FGameplayTag SiblingTag = (*SiblingTags)[i];
+			if (SiblingTag.MatchesTag(PropertyTag))
 			{
-				// Direct child - always include
-				UniqueChildTags.Add(Tag);
+				AdoptedChildren.Add(SiblingTag);
+				ParentPropertyTags.Add(SiblingTag, PropertyTag);
+				SiblingTags->RemoveAt(i);
 			}
-			// Check if this is a non-direct child without intermediate nodes
-			else if (TagDepth > ParentDepth + 1)
+			else
 			{
-				// Check if there are any intermediate nodes between parent and this tag
-				bool HasIntermediateNodes = false;
-				
-				// Find the next part of the tag
-				FString RemainingPart = TagString.Mid(ParentTagString.Len() + 1);
-				TArray<FString> RemainingParts;
-				RemainingPart.ParseIntoArray(RemainingParts, TEXT("."));
-				
-				// Check each possible intermediate level
-				for (int32 IntermediateDepth = ParentDepth + 1; IntermediateDepth < TagDepth; ++IntermediateDepth)
-				{
-					// Build the intermediate tag string
-					FString IntermediateTagString = ParentTagString;
-					for (int32 i = 0; i < IntermediateDepth - ParentDepth; ++i)
-					{						
-						if (i < RemainingParts.Num())
-						{
-							IntermediateTagString += TEXT(".") + RemainingParts[i];
-						}
-					}
-
-					// Check if this intermediate tag exists in the collection
-					FGameplayTag IntermediateTag = FGameplayTag::RequestGameplayTag(FName(*IntermediateTagString), false);
-					if (IntermediateTag.IsValid() && GetProperty(IntermediateTag) != nullptr)
-					{
-						HasIntermediateNodes = true;
-						break;
-					}
-				}
-
-				// If no intermediate nodes exist, this is a valid non-direct child
-				if (!HasIntermediateNodes)
-				{
-					UniqueChildTags.Add(Tag);
-				}
+				++i;
 			}
 		}
 	}
 
-	// Convert set to array for output
-	OutChildTags = UniqueChildTags.Array();
+	if (AdoptedChildren.Num() > 0)
+	{
+		ChildPropertyTags.FindOrAdd(PropertyTag).Append(MoveTemp(AdoptedChildren));
+	}
+	ChildPropertyTags.FindOrAdd(ParentTag).Add(PropertyTag);
 }
 
+FGameplayTag UCascadeDynamicPropertiesContainer::RemoveFromHierarchyIndex(FGameplayTag PropertyTag, TArray<FGameplayTag>& OutAdoptedChildren)
+{
+	OutAdoptedChildren.Reset();
+	ResolvedAncestorTags.Reset();
+
+	FGameplayTag ParentTag;
+	if (!ParentPropertyTags.RemoveAndCopyValue(PropertyTag, ParentTag))
+	{
+		return FGameplayTag();
+	}
+
+	ChildPropertyTags.RemoveAndCopyValue(PropertyTag, OutAdoptedChildren);
+	for (const FGameplayTag& ChildTag : OutAdoptedChildren)
+	{
+		ParentPropertyTags.Add(ChildTag, ParentTag);
+	}
+
+	TArray<FGameplayTag>& SiblingTags = ChildPropertyTags.FindOrAdd(ParentTag);
+	SiblingTags.Remove(PropertyTag);
+	SiblingTags.Append(OutAdoptedChildren);
+
+	return ParentTag;
+}
@@ -1,6 +1,9 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "DynamicProperties.h"
+#include "DynamicPropertiesLog.h"
+
+DEFINE_LOG_CATEGORY(LogDynamicProperties);
 
 #define LOCTEXT_NAMESPACE "FDynamicPropertiesModule"
 
@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertiesBatchEvaluator.h"
+#include "Math/VectorRegister.h"
+
+namespace DynamicPropertiesBatchEvaluator
+{
+	/** Number of properties evaluated per vector register */
+	constexpr int32 LaneCount = 4;
+}
+
+void FDynamicPropertiesBatchEvaluator::EvaluateStacks(TArrayView<const float> BaseValues, TArrayView<const FModifierLinearOp> Ops, TArrayView<const int32> OpStarts, TArrayView<const int32> OpCounts, TArrayView<float> OutValues)
+{
+	using namespace DynamicPropertiesBatchEvaluator;
+
+	const int32 NumProperties = BaseValues.Num();
+	check(OpStarts.Num() == NumProperties && OpCounts.Num() == NumProperties && OutValues.Num() >= NumProperties);
+
+	const int32 NumVectorized = NumProperties - NumProperties % LaneCount;
+	for (int32 First = 0; First < NumVectorized; First += LaneCount)
+	{
+		int32 MaxCount = 0;
+		for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+		{
+			MaxCount = FMath::Max(MaxCount, OpCounts[First + Lane]);
+		}
+
+		const VectorRegister4Float Base = VectorLoad(BaseValues.GetData() + First);
+		VectorRegister4Float Current = Base;
+
+		// Stacks are applied in lockstep, lanes whose stack is done keep their value
+		// Padding with identity ops instead would turn infinite base values into NaN through Base * 0
+		for (int32 Step = 0; Step < MaxCount; ++Step)
+		{
+			alignas(16) float CurrentScales[LaneCount];
+			alignas(16) float BaseScales[LaneCount];
+			alignas(16) float Offsets[LaneCount];
+			alignas(16) float Active[LaneCount];
+			for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+			{
+				const int32 Property = First + Lane;
+				const bool bActive = Step < OpCounts[Property];
+				const FModifierLinearOp Op = bActive ? Ops[OpStarts[Property] + Step] : FModifierLinearOp();
+				CurrentScales[Lane] = Op.CurrentScale;
+				BaseScales[Lane] = Op.BaseScale;
+				Offsets[Lane] = Op.Offset;
+				Active[Lane] = bActive ? 1.0f : 0.0f;
+			}
+
+			// Same operation order as FModifierLinearOp::Apply, no fused multiply-add, so lanes match the scalar path
+			const VectorRegister4Float ScaledCurrent = VectorMultiply(Current, VectorLoadAligned(CurrentScales));
+			const VectorRegister4Float ScaledBase = VectorMultiply(Base, VectorLoadAligned(BaseScales));
+			const VectorRegister4Float Next = VectorAdd(VectorAdd(ScaledCurrent, ScaledBase), VectorLoadAligned(Offsets));
+			Current = VectorSelect(VectorCompareGT(VectorLoadAligned(Active), VectorZeroFloat()), Next, Current);
+		}
+
+		VectorStore(Current, OutValues.GetData() + First);
+	}
+
+	// Scalar tail
+	for (int32 Property = NumVectorized; Property < NumProperties; ++Property)
+	{
+		const float Base = BaseValues[Property];
+		float Current = Base;
+		for (int32 Step = 0; Step < OpCounts[Property]; ++Step)
+		{
+			Current = Ops[OpStarts[Property] + Step].Apply(Base, Current);
+		}
+		OutValues[Property] = Current;
+	}
+}
+
+void FDynamicPropertiesBatchEvaluator::EvaluateAffine(TArrayView<const float> BaseValues, TArrayView<const float> Scales, TArrayView<const float> Offsets, TArrayView<float> OutValues)
+{
+	using namespace DynamicPropertiesBatchEvaluator;
+
+	const int32 NumProperties = BaseValues.Num();
+	check(Scales.Num() == NumProperties && Offsets.Num() == NumProperties && OutValues.Num() >= NumProperties);
+
+	const int32 NumVectorized = NumProperties - NumProperties % LaneCount;
+	for (int32 First = 0; First < NumVectorized; First += LaneCount)
+	{
+		const VectorRegister4Float Base = VectorLoad(BaseValues.GetData() + First);
+		const VectorRegister4Float Scale = VectorLoad(Scales.GetData() + First);
+		const VectorRegister4Float Offset = VectorLoad(Offsets.GetData() + First);
+		// Separate multiply and add, VectorMultiplyAdd may be fused and round differently from the scalar tail
+		VectorStore(VectorAdd(VectorMultiply(Base, Scale), Offset), OutValues.GetData() + First);
+	}
+
+	// Scalar tail
+	for (int32 Property = NumVectorized; Property < NumProperties; ++Property)
+	{
+		OutValues[Property] = BaseValues[Property] * Scales[Property] + Offsets[Property];
+	}
+}
+
+FModifierAffineForm FDynamicPropertiesBatchEvaluator::CollapseLinearOps(TArrayView<const FModifierLinearOp> Ops)
+{
+	// Current = Base * Scale + Offset holds before the first op (Scale 1, Offset 0) and is preserved by every op:
+	// Current * CS + Base * BS + O = Base * (Scale * CS + BS) + (Offset * CS + O)
+	FModifierAffineForm Form;
+	for (const FModifierLinearOp& Op : Ops)
+	{
+		Form.Scale = Form.Scale * Op.CurrentScale + Op.BaseScale;
+		Form.Offset = Form.Offset * Op.CurrentScale + Op.Offset;
+	}
+	return Form;
+}
@@ -1,10 +1,98 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "DynamicPropertiesContainer.h"
+#include "DynamicPropertiesLog.h"
+#include "DynamicPropertiesSubsystem.h"
+#include "DynamicPropertiesSnapshot.h"
+#include "DynamicPropertiesStats.h"
+#include "DynamicPropertiesPreset.h"
+#include "SharedModifier.h"
+#include "Algo/StableSort.h"
+#include "Algo/Unique.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Serialization/ArchiveCountMem.h"
 
 UDynamicPropertiesContainer::UDynamicPropertiesContainer()
 {
 	PrimaryComponentTick.bCanEverTick = false;
+
+	ReplicatedValues.Owner = this;
+	CompactProperties.Owner = this;
+}
+
+void UDynamicPropertiesContainer::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UDynamicPropertiesContainer* This = CastChecked<UDynamicPropertiesContainer>(InThis);
+	This->CompactProperties.AddReferencedObjects(Collector);
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+void UDynamicPropertiesContainer::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	if (Ar.IsCountingMemory())
+	{
+		const SIZE_T NativeSize = GetAllocatedSize();
+		Ar.CountBytes(NativeSize, NativeSize);
+	}
+}
+
+void UDynamicPropertiesContainer::PostLoad()
+{
+	Super::PostLoad();
+
+	ValueChangedBinders_DEPRECATED.Empty();
+
+	// Loaded property objects don't know their container yet
+	for (const TPair<FGameplayTag, UDynamicProperty*>& Pair : DynamicProperties)
+	{
+		if (Pair.Value)
+		{
+			Pair.Value->SetOwningContainer(this, Pair.Key);
+		}
+	}
+
+	RebuildPropertyInputs();
+}
+
+void UDynamicPropertiesContainer::BeginPlay()
+{
+	// Properties exist before any Blueprint BeginPlay reads them
+	if (InitialPreset)
+	{
+		InitializeFromPreset(InitialPreset);
+	}
+
+	Super::BeginPlay();
+
+	// Properties added before the component could replicate are sent now
+	if (ShouldReplicateValues())
+	{
+		TArray<FGameplayTag> PropertyTags;
+		GetPropertiesKeys(PropertyTags);
+		for (const FGameplayTag& PropertyTag : PropertyTags)
+		{
+			float Value = 0.0f;
+			if (FindPropertyValue(PropertyTag, Value))
+			{
+				ReplicatePropertyValue(PropertyTag, Value);
+			}
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UDynamicPropertiesContainer, ReplicatedValues, Params);
 }
 
 UDynamicProperty* UDynamicPropertiesContainer::GetProperty(FGameplayTag PropertyTag)
@@ -13,15 +101,26 @@ UDynamicProperty* UDynamicPropertiesContainer::GetProperty(FGameplayTag Property
 	{
 		return *FoundProperty;
 	}
+
+	// Blueprint code works with property objects, so compact properties are turned into one on request
+	return PromoteCompactProperty(PropertyTag);
+}
+
+UDynamicProperty* UDynamicPropertiesContainer::FindPropertyObject(FGameplayTag PropertyTag) const
+{
+	if (UDynamicProperty* const* FoundProperty = DynamicProperties.Find(PropertyTag))
+	{
+		return *FoundProperty;
+	}
 	return nullptr;
 }
 
 UDynamicProperty* UDynamicPropertiesContainer::GetOrAddProperty(FGameplayTag PropertyTag, float BaseValue)
 {
 	// Check if property already exists
-	if (UDynamicProperty** FoundProperty = DynamicProperties.Find(PropertyTag))
+	if (UDynamicProperty* FoundProperty = GetProperty(PropertyTag))
 	{
-		return *FoundProperty;
+		return FoundProperty;
 	}
 
 	// Create new property
@@ -29,78 +128,1432 @@ UDynamicProperty* UDynamicPropertiesContainer::GetOrAddProperty(FGameplayTag Pro
 	if (NewProperty)
 	{
 		NewProperty->SetBaseValue(BaseValue);
+		NewProperty->SetLazyEvaluation(UsesLazyEvaluation());
 		DynamicProperties.Add(PropertyTag, NewProperty);
 		
-		// Bind to the property's ValueChanged event
-		BindPropertyValueChanged(PropertyTag, NewProperty);
+		// Route the property's value changes to this container
+		NewProperty->SetOwningContainer(this, PropertyTag);
 		
 		// Call virtual hook for derived classes (also fires initial OnPropertyValueChanged)
 		OnPropertyAddedInternal(PropertyTag, NewProperty);
+
+		// Properties added during a batch join it
+		if (IsBatching())
+		{
+			NewProperty->BeginBatch();
+		}
 	}
 
 	return NewProperty;
 }
 
-void UDynamicPropertiesContainer::BindPropertyValueChanged(FGameplayTag PropertyTag, UDynamicProperty* Property)
+bool UDynamicPropertiesContainer::AddProperty(FGameplayTag PropertyTag, float BaseValue)
+{
+	if (HasProperty(PropertyTag))
+	{
+		return false;
+	}
+
+	if (bUseCompactStorage)
+	{
+		GetOrAddPropertyHandle(PropertyTag, BaseValue);
+	}
+	else
+	{
+		GetOrAddProperty(PropertyTag, BaseValue);
+	}
+
+	return true;
+}
+
+FDynamicPropertyHandle UDynamicPropertiesContainer::GetOrAddPropertyHandle(FGameplayTag PropertyTag, float BaseValue)
+{
+	const FDynamicPropertyHandle FoundHandle = CompactProperties.Find(PropertyTag);
+	if (FoundHandle.IsValid() || DynamicProperties.Contains(PropertyTag))
+	{
+		return FoundHandle;
+	}
+
+	CompactProperties.Add(PropertyTag, BaseValue);
+
+	// Call virtual hook for derived classes (also fires initial OnPropertyValueChanged)
+	OnPropertyAddedInternal(PropertyTag, nullptr);
+
+	// The hook may have changed the compact storage, so look the handle up again
+	return CompactProperties.Find(PropertyTag);
+}
+
+bool UDynamicPropertiesContainer::RemoveProperty(FGameplayTag PropertyTag)
+{
+	TArray<UModifier*> RemovedModifiers;
+	if (CompactProperties.Remove(PropertyTag, &RemovedModifiers))
+	{
+		for (UModifier* Modifier : RemovedModifiers)
+		{
+			HandlePropertyModifierRemoved(PropertyTag, Modifier);
+		}
+
+		// Call virtual hook for derived classes
+		OnPropertyRemovedInternal(PropertyTag, nullptr);
+		return true;
+	}
+
+	UDynamicProperty* RemovedProperty = nullptr;
+	if (!DynamicProperties.RemoveAndCopyValue(PropertyTag, RemovedProperty))
+	{
+		return false;
+	}
+
+	DirtyPropertyTags.Remove(PropertyTag);
+
+	// Leave the container batch, the property is no longer observed by the container so its pending changes are applied silently
+	if (RemovedProperty)
+	{
+		// Shared modifiers stop updating the property, which keeps its modifiers
+		for (UModifier* Modifier : RemovedProperty->Modifiers)
+		{
+			HandlePropertyModifierRemoved(PropertyTag, Modifier);
+		}
+
+		RemovedProperty->SetOwningContainer(nullptr, FGameplayTag());
+		if (IsBatching())
+		{
+			RemovedProperty->EndBatch();
+		}
+	}
+
+	// Call virtual hook for derived classes
+	OnPropertyRemovedInternal(PropertyTag, RemovedProperty);
+
+	return true;
+}
+
+bool UDynamicPropertiesContainer::HasProperty(FGameplayTag PropertyTag) const
+{
+	return DynamicProperties.Contains(PropertyTag) || CompactProperties.Find(PropertyTag).IsValid();
+}
+
+UDynamicProperty* UDynamicPropertiesContainer::PromoteCompactProperty(FGameplayTag PropertyTag)
+{
+	const int32 Index = CompactProperties.Find(PropertyTag).Index;
+	if (Index == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	const float OldValue = CompactProperties.GetValue(Index);
+	const float BaseValue = CompactProperties.GetBaseValue(Index);
+	TArray<UModifier*> PropertyModifiers;
+	CompactProperties.Remove(PropertyTag, &PropertyModifiers);
+
+	UDynamicProperty* Property = NewObject<UDynamicProperty>(this);
+	{
+		// Rebuild the property silently: it isn't bound yet, and one recalculation is enough
+		FDynamicPropertyBatchScope PropertyBatch(Property);
+		Property->SetBaseValue(BaseValue);
+		for (UModifier* Modifier : PropertyModifiers)
+		{
+			Property->AddModifier(Modifier);
+		}
+	}
+
+	Property->SetLazyEvaluation(UsesLazyEvaluation());
+	DynamicProperties.Add(PropertyTag, Property);
+	Property->SetOwningContainer(this, PropertyTag);
+
+	if (IsBatching())
+	{
+		Property->BeginBatch();
+	}
+
+	// Changes still pending from a batch are reported now
+	const float NewValue = Property->GetValue();
+	if (!FMath::IsNearlyEqual(OldValue, NewValue))
+	{
+		OnPropertyValueChangedInternal(PropertyTag, OldValue, NewValue);
+	}
+
+	return Property;
+}
+
+void UDynamicPropertiesContainer::SetPropertyBaseValue(FGameplayTag PropertyTag, float NewBaseValue)
+{
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		Property->SetBaseValue(NewBaseValue);
+	}
+	else
+	{
+		SetPropertyBaseValueByHandle(CompactProperties.Find(PropertyTag), NewBaseValue);
+	}
+}
+
+void UDynamicPropertiesContainer::AddPropertyModifier(FGameplayTag PropertyTag, UModifier* Modifier)
+{
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		Property->AddModifier(Modifier);
+	}
+	else
+	{
+		AddPropertyModifierByHandle(CompactProperties.Find(PropertyTag), Modifier);
+	}
+}
+
+void UDynamicPropertiesContainer::RemovePropertyModifier(FGameplayTag PropertyTag, UModifier* Modifier)
+{
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		Property->RemoveModifier(Modifier);
+	}
+	else
+	{
+		RemovePropertyModifierByHandle(CompactProperties.Find(PropertyTag), Modifier);
+	}
+}
+
+void UDynamicPropertiesContainer::AddTimedPropertyModifier(FGameplayTag PropertyTag, UModifier* Modifier, float Duration)
 {
-	if (!Property)
+	if (!Modifier || !HasProperty(PropertyTag))
 	{
 		return;
 	}
 
-	// Create a binder object that will forward the event with the property tag
-	UPropertyValueChangedBinder* Binder = NewObject<UPropertyValueChangedBinder>(this);
-	if (Binder)
+	// Only property objects hand out modifier handles, so a compact property is turned into one and expires by handle
+	if (UDynamicProperty* Property = GetProperty(PropertyTag))
 	{
-		// Bind the binder to the property
-		Binder->BindToProperty(Property, PropertyTag);
-		
-		// Store the binder to prevent garbage collection
-		ValueChangedBinders.Add(Binder);
+		Property->AddTimedModifier(Modifier, Duration);
+	}
+}
 
-		// Bind our handler to the binder's event
-		Binder->OnBinderValueChanged.AddDynamic(this, &UDynamicPropertiesContainer::HandleBinderValueChanged);
+bool UDynamicPropertiesContainer::SubscribeToSharedModifier(FGameplayTag PropertyTag, USharedModifier* SharedModifier)
+{
+	if (!SharedModifier || !HasProperty(PropertyTag))
+	{
+		return false;
 	}
+
+	AddPropertyModifier(PropertyTag, SharedModifier);
+	SharedModifier->AddSubscriber(this, PropertyTag);
+
+	return true;
 }
 
-void UDynamicPropertiesContainer::HandleBinderValueChanged(FGameplayTag PropertyTag, float OldValue, float NewValue)
+void UDynamicPropertiesContainer::UnsubscribeFromSharedModifier(FGameplayTag PropertyTag, USharedModifier* SharedModifier)
 {
-	// Call virtual hook for derived classes (also broadcasts OnPropertyValueChanged)
-	OnPropertyValueChangedInternal(PropertyTag, OldValue, NewValue);
+	// Removing the modifier ends the subscription
+	if (SharedModifier)
+	{
+		RemovePropertyModifier(PropertyTag, SharedModifier);
+	}
 }
 
-void UDynamicPropertiesContainer::OnPropertyValueChangedInternal(FGameplayTag PropertyTag, float OldValue, float NewValue)
+void UDynamicPropertiesContainer::HandlePropertyModifierRemoved(FGameplayTag PropertyTag, UModifier* Modifier)
 {
-	// Base implementation broadcasts the event
-	OnPropertyValueChanged.Broadcast(PropertyTag, OldValue, NewValue);
+	// Each subscription applied the shared modifier once, so each removed instance ends one
+	if (USharedModifier* SharedModifier = Cast<USharedModifier>(Modifier))
+	{
+		SharedModifier->RemoveSubscriber(this, PropertyTag);
+	}
 }
 
-float UDynamicPropertiesContainer::GetPropertyValueOrDefault(FGameplayTag PropertyTag, float DefaultValue)
+void UDynamicPropertiesContainer::RefreshPropertyModifiers(FGameplayTag PropertyTag)
 {
-	if (UDynamicProperty** FoundProperty = DynamicProperties.Find(PropertyTag))
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		Property->RefreshModifiers();
+		return;
+	}
+
+	const int32 Index = CompactProperties.Find(PropertyTag).Index;
+	if (Index != INDEX_NONE)
+	{
+		CompactProperties.RefreshModifiers(Index);
+		UpdatePropertyInputs(PropertyTag);
+		ApplyCompactPropertyChange(Index);
+	}
+}
+
+int32 UDynamicPropertiesContainer::RemoveModifiersBySource(const UObject* Source)
+{
+	if (!Source)
+	{
+		return 0;
+	}
+
+	FDynamicPropertiesContainerBatchScope Batch(this);
+
+	int32 NumRemoved = 0;
+	for (const TPair<FGameplayTag, UDynamicProperty*>& Pair : DynamicProperties)
 	{
-		if (*FoundProperty)
+		if (Pair.Value)
 		{
-			return (*FoundProperty)->GetValue();
+			NumRemoved += Pair.Value->RemoveModifiersBySource(Source);
 		}
 	}
-	return DefaultValue;
+
+	return NumRemoved;
 }
 
-void UDynamicPropertiesContainer::GetPropertiesKeys(TArray<FGameplayTag>& OutKeys)
+float UDynamicPropertiesContainer::GetPropertyValueByHandle(const FDynamicPropertyHandle& Handle, float DefaultValue) const
 {
-	DynamicProperties.GetKeys(OutKeys);
+	const int32 Index = CompactProperties.Resolve(Handle);
+	if (Index != INDEX_NONE)
+	{
+		return CompactProperties.GetValue(Index);
+	}
+
+	// The property may have been turned into an object since the handle was taken
+	const UDynamicProperty* Property = FindPropertyObject(Handle.Tag);
+	return Property ? Property->GetValue() : DefaultValue;
 }
 
-void UDynamicPropertiesContainer::OnPropertyAddedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property)
+float UDynamicPropertiesContainer::GetPropertyBaseValueByHandle(const FDynamicPropertyHandle& Handle, float DefaultValue) const
+{
+	const int32 Index = CompactProperties.Resolve(Handle);
+	if (Index != INDEX_NONE)
+	{
+		return CompactProperties.GetBaseValue(Index);
+	}
+
+	const UDynamicProperty* Property = FindPropertyObject(Handle.Tag);
+	return Property ? Property->GetBaseValue() : DefaultValue;
+}
+
+void UDynamicPropertiesContainer::SetPropertyBaseValueByHandle(const FDynamicPropertyHandle& Handle, float NewBaseValue)
+{
+	const int32 Index = CompactProperties.Resolve(Handle);
+	if (Index != INDEX_NONE)
+	{
+		if (CompactProperties.SetBaseValue(Index, NewBaseValue))
+		{
+			ApplyCompactPropertyChange(Index);
+		}
+	}
+	else if (UDynamicProperty* Property = FindPropertyObject(Handle.Tag))
+	{
+		Property->SetBaseValue(NewBaseValue);
+	}
+}
+
+void UDynamicPropertiesContainer::AddPropertyModifierByHandle(const FDynamicPropertyHandle& Handle, UModifier* Modifier)
+{
+	const int32 Index = CompactProperties.Resolve(Handle);
+	if (Index != INDEX_NONE)
+	{
+		if (CompactProperties.AddModifier(Index, Modifier))
+		{
+			UpdatePropertyInputs(CompactProperties.GetTag(Index));
+			ApplyCompactPropertyChange(Index);
+		}
+	}
+	else if (UDynamicProperty* Property = FindPropertyObject(Handle.Tag))
+	{
+		Property->AddModifier(Modifier);
+	}
+}
+
+void UDynamicPropertiesContainer::RemovePropertyModifierByHandle(const FDynamicPropertyHandle& Handle, UModifier* Modifier)
+{
+	const int32 Index = CompactProperties.Resolve(Handle);
+	if (Index != INDEX_NONE)
+	{
+		if (CompactProperties.RemoveModifier(Index, Modifier))
+		{
+			HandlePropertyModifierRemoved(CompactProperties.GetTag(Index), Modifier);
+			UpdatePropertyInputs(CompactProperties.GetTag(Index));
+			ApplyCompactPropertyChange(Index);
+		}
+	}
+	else if (UDynamicProperty* Property = FindPropertyObject(Handle.Tag))
+	{
+		Property->RemoveModifier(Modifier);
+	}
+}
+
+void UDynamicPropertiesContainer::ApplyCompactPropertyChange(int32 Index)
 {
-	if (!Property)
+	if (IsBatching())
 	{
+		CompactProperties.MarkDirty(Index);
 		return;
 	}
 
-	// Fire value changed event for the initial value (transition from non-existent to existent)
-	float InitialValue = Property->GetValue();
-	OnPropertyValueChanged.Broadcast(PropertyTag, InitialValue, InitialValue);
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_Recalculate);
+	DYNAMIC_PROPERTIES_COUNT(Recalculations, this, CompactProperties.GetTag(Index), 1);
+
+	float OldValue = 0.0f;
+	if (CompactProperties.Recalculate(Index, OldValue))
+	{
+		OnPropertyValueChangedInternal(CompactProperties.GetTag(Index), OldValue, CompactProperties.GetValue(Index));
+	}
+}
+
+void UDynamicPropertiesContainer::HandlePropertyValueChanged(FGameplayTag PropertyTag, float OldValue, float NewValue)
+{
+	// Call virtual hook for derived classes (also broadcasts OnPropertyValueChanged)
+	OnPropertyValueChangedInternal(PropertyTag, OldValue, NewValue);
+}
+
+void UDynamicPropertiesContainer::HandlePropertyDirty(FGameplayTag PropertyTag)
+{
+	DirtyPropertyTags.Add(PropertyTag);
+
+	// Queue for end of frame evaluation
+	if (bEvaluateInWorldSubsystem && !bRegisteredWithSubsystem)
+	{
+		UWorld* World = GetWorld();
+		if (UDynamicPropertiesSubsystem* Subsystem = World ? World->GetSubsystem<UDynamicPropertiesSubsystem>() : nullptr)
+		{
+			Subsystem->RegisterDirtyContainer(this);
+			bRegisteredWithSubsystem = true;
+		}
+	}
+
+	// Lazy properties reading this one are out of date as well
+	if (PropertyInputs.Num() > 0)
+	{
+		EnsureDependencyOrder();
+		if (const TArray<FGameplayTag>* Dependents = PropertyDependents.Find(PropertyTag))
+		{
+			const TArray<FGameplayTag, TInlineAllocator<16>> DependentsToMark(*Dependents);
+			for (const FGameplayTag& DependentTag : DependentsToMark)
+			{
+				if (!CyclicPropertyTags.Contains(DependentTag))
+				{
+					MarkPropertyDirty(DependentTag);
+				}
+			}
+		}
+	}
+
+	// Call virtual hook for derived classes
+	OnPropertyDirtyInternal(PropertyTag);
+}
+
+void UDynamicPropertiesContainer::OnPropertyDirtyInternal(FGameplayTag PropertyTag)
+{
+	// Base implementation has no dependencies between properties
+}
+
+void UDynamicPropertiesContainer::FlushPropertyDependencies(FGameplayTag PropertyTag)
+{
+	const TArray<FGameplayTag>* Inputs = PropertyInputs.Find(PropertyTag);
+	if (!Inputs)
+	{
+		return;
+	}
+
+	// Flushing along a cycle would never end
+	EnsureDependencyOrder();
+	if (CyclicPropertyTags.Contains(PropertyTag))
+	{
+		return;
+	}
+
+	// Properties read by this property's modifiers are brought up to date first
+	const TArray<FGameplayTag, TInlineAllocator<8>> InputsToFlush(*Inputs);
+	for (const FGameplayTag& InputTag : InputsToFlush)
+	{
+		if (UDynamicProperty* InputProperty = FindPropertyObject(InputTag))
+		{
+			InputProperty->FlushPendingChanges();
+		}
+	}
+}
+
+bool UDynamicPropertiesContainer::HasDependencyCycle()
+{
+	EnsureDependencyOrder();
+	return CyclicPropertyTags.Num() > 0;
+}
+
+void UDynamicPropertiesContainer::GetDependentProperties(FGameplayTag PropertyTag, TArray<FGameplayTag>& OutDependents)
+{
+	EnsureDependencyOrder();
+
+	const TArray<FGameplayTag>* Dependents = PropertyDependents.Find(PropertyTag);
+	OutDependents = Dependents ? *Dependents : TArray<FGameplayTag>();
 }
 
+void UDynamicPropertiesContainer::UpdatePropertyInputs(FGameplayTag PropertyTag)
+{
+	TArray<FGameplayTag> Inputs;
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		for (const UModifier* Modifier : Property->Modifiers)
+		{
+			if (Modifier)
+			{
+				Modifier->GetPropertyDependencies(Inputs);
+			}
+		}
+	}
+	else
+	{
+		const int32 Index = CompactProperties.Find(PropertyTag).Index;
+		if (Index != INDEX_NONE)
+		{
+			TArray<UModifier*> PropertyModifiers;
+			CompactProperties.GetModifiers(Index, PropertyModifiers);
+			for (const UModifier* Modifier : PropertyModifiers)
+			{
+				if (Modifier)
+				{
+					Modifier->GetPropertyDependencies(Inputs);
+				}
+			}
+		}
+	}
+
+	Inputs.Sort();
+	Inputs.SetNum(Algo::Unique(Inputs));
+
+	TArray<FGameplayTag>* ExistingInputs = PropertyInputs.Find(PropertyTag);
+	if (Inputs.Num() == 0)
+	{
+		if (ExistingInputs)
+		{
+			PropertyInputs.Remove(PropertyTag);
+			bDependencyOrderDirty = true;
+		}
+	}
+	else if (!ExistingInputs || *ExistingInputs != Inputs)
+	{
+		PropertyInputs.Add(PropertyTag, MoveTemp(Inputs));
+		bDependencyOrderDirty = true;
+	}
+}
+
+void UDynamicPropertiesContainer::RebuildPropertyInputs()
+{
+	PropertyInputs.Reset();
+	bDependencyOrderDirty = true;
+
+	TArray<FGameplayTag> PropertyTags;
+	GetPropertiesKeys(PropertyTags);
+	for (const FGameplayTag& PropertyTag : PropertyTags)
+	{
+		UpdatePropertyInputs(PropertyTag);
+	}
+}
+
+void UDynamicPropertiesContainer::EnsureDependencyOrder()
+{
+	if (!bDependencyOrderDirty)
+	{
+		return;
+	}
+
+	bDependencyOrderDirty = false;
+	PropertyDependents.Reset();
+	DependencyRanks.Reset();
+	CyclicPropertyTags.Reset();
+
+	// Kahn's algorithm: a property is ranked once every property it reads is
+	TMap<FGameplayTag, int32> NumUnrankedInputs;
+	for (const TPair<FGameplayTag, TArray<FGameplayTag>>& Pair : PropertyInputs)
+	{
+		NumUnrankedInputs.FindOrAdd(Pair.Key) += Pair.Value.Num();
+		for (const FGameplayTag& InputTag : Pair.Value)
+		{
+			PropertyDependents.FindOrAdd(InputTag).Add(Pair.Key);
+			NumUnrankedInputs.FindOrAdd(InputTag);
+		}
+	}
+
+	TArray<FGameplayTag> ReadyTags;
+	for (const TPair<FGameplayTag, int32>& Pair : NumUnrankedInputs)
+	{
+		if (Pair.Value == 0)
+		{
+			ReadyTags.Add(Pair.Key);
+			DependencyRanks.Add(Pair.Key, 0);
+		}
+	}
+
+	for (int32 ReadyIndex = 0; ReadyIndex < ReadyTags.Num(); ++ReadyIndex)
+	{
+		const FGameplayTag ReadyTag = ReadyTags[ReadyIndex];
+		const TArray<FGameplayTag>* Dependents = PropertyDependents.Find(ReadyTag);
+		if (!Dependents)
+		{
+			continue;
+		}
+
+		const int32 DependentRank = DependencyRanks[ReadyTag] + 1;
+		for (const FGameplayTag& DependentTag : *Dependents)
+		{
+			int32& Rank = DependencyRanks.FindOrAdd(DependentTag);
+			Rank = FMath::Max(Rank, DependentRank);
+
+			if (--NumUnrankedInputs[DependentTag] == 0)
+			{
+				ReadyTags.Add(DependentTag);
+			}
+		}
+	}
+
+	// Whatever still waits on an input is on a cycle, or downstream of one
+	for (const TPair<FGameplayTag, int32>& Pair : NumUnrankedInputs)
+	{
+		if (Pair.Value > 0)
+		{
+			CyclicPropertyTags.Add(Pair.Key);
+			DependencyRanks.Remove(Pair.Key);
+		}
+	}
+
+	if (CyclicPropertyTags.Num() > 0)
+	{
+		FString CycleTags;
+		for (const FGameplayTag& CyclicTag : CyclicPropertyTags)
+		{
+			CycleTags += CycleTags.IsEmpty() ? CyclicTag.ToString() : TEXT(", ") + CyclicTag.ToString();
+		}
+		UE_LOG(LogDynamicProperties, Warning, TEXT("UDynamicPropertiesContainer::EnsureDependencyOrder - Dependency cycle through %s. These properties are not updated when their inputs change."), *CycleTags);
+	}
+}
+
+void UDynamicPropertiesContainer::UpdateDependentProperties(FGameplayTag PropertyTag)
+{
+	// Replicated values already include the effect of their inputs
+	if (PropertyInputs.Num() == 0 || IsApplyingReplicatedValues())
+	{
+		return;
+	}
+
+	EnsureDependencyOrder();
+
+	const TArray<FGameplayTag>* Dependents = PropertyDependents.Find(PropertyTag);
+	if (!Dependents)
+	{
+		return;
+	}
+
+	for (const FGameplayTag& DependentTag : *Dependents)
+	{
+		const int32* Rank = DependencyRanks.Find(DependentTag);
+		if (Rank && !QueuedDependents.Contains(DependentTag))
+		{
+			QueuedDependents.Add(DependentTag);
+			PendingDependents.HeapPush(TPair<int32, FGameplayTag>(*Rank, DependentTag), [](const TPair<int32, FGameplayTag>& A, const TPair<int32, FGameplayTag>& B)
+			{
+				return A.Key < B.Key;
+			});
+		}
+	}
+
+	// Changes of the dependents themselves only queue further dependents, the outermost call works through the queue
+	if (bUpdatingDependents)
+	{
+		return;
+	}
+
+	TGuardValue<bool> UpdatingGuard(bUpdatingDependents, true);
+	while (PendingDependents.Num() > 0)
+	{
+		TPair<int32, FGameplayTag> Pending;
+		PendingDependents.HeapPop(Pending, [](const TPair<int32, FGameplayTag>& A, const TPair<int32, FGameplayTag>& B)
+		{
+			return A.Key < B.Key;
+		}, false);
+		QueuedDependents.Remove(Pending.Value);
+
+		if (UDynamicProperty* Property = FindPropertyObject(Pending.Value))
+		{
+			Property->ApplyValueChange();
+		}
+		else
+		{
+			const int32 Index = CompactProperties.Find(Pending.Value).Index;
+			if (Index != INDEX_NONE)
+			{
+				ApplyCompactPropertyChange(Index);
+			}
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::MarkPropertyDirty(FGameplayTag PropertyTag)
+{
+	UDynamicProperty* Property = FindPropertyObject(PropertyTag);
+	if (Property && Property->bLazyEvaluation)
+	{
+		Property->MarkValueDirty();
+	}
+}
+
+bool UDynamicPropertiesContainer::SetPropertyBaseValueSilently(FGameplayTag PropertyTag, float NewBaseValue, float& OutOldValue, float& OutNewValue)
+{
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		if (!Property->SetBaseValueSilently(NewBaseValue, OutOldValue))
+		{
+			return false;
+		}
+
+		OutNewValue = Property->Value;
+		return true;
+	}
+
+	const int32 Index = CompactProperties.Find(PropertyTag).Index;
+	if (Index == INDEX_NONE || !CompactProperties.SetBaseValue(Index, NewBaseValue))
+	{
+		return false;
+	}
+
+	if (IsBatching())
+	{
+		CompactProperties.MarkDirty(Index);
+		return false;
+	}
+
+	if (!CompactProperties.Recalculate(Index, OutOldValue))
+	{
+		return false;
+	}
+
+	OutNewValue = CompactProperties.GetValue(Index);
+	return true;
+}
+
+void UDynamicPropertiesContainer::BroadcastPropertyValueChanged(FGameplayTag PropertyTag, float OldValue, float NewValue)
+{
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		Property->BroadcastValueChanged(OldValue, NewValue);
+	}
+}
+
+int32 UDynamicPropertiesContainer::PrecomputePendingValues()
+{
+	int32 NumPrecomputed = 0;
+	for (const FGameplayTag& PropertyTag : DirtyPropertyTags)
+	{
+		UDynamicProperty* Property = FindPropertyObject(PropertyTag);
+		float PrecomputedValue = 0.0f;
+		if (Property && Property->IsValueDirty() && Property->PrecomputeValue(Property->GetBaseValue(), PrecomputedValue))
+		{
+			++NumPrecomputed;
+		}
+	}
+	return NumPrecomputed;
+}
+
+void UDynamicPropertiesContainer::FlushPendingChanges()
+{
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_Flush);
+
+	// Flushing may dirty other properties through change listeners, so repeat until nothing is left
+	while (DirtyPropertyTags.Num() > 0)
+	{
+		const TArray<FGameplayTag> TagsToFlush = DirtyPropertyTags.Array();
+		DirtyPropertyTags.Reset();
+
+		for (const FGameplayTag& PropertyTag : TagsToFlush)
+		{
+			if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+			{
+				Property->FlushPendingChanges();
+			}
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::RecalculateAllProperties()
+{
+	// Changes are folded into one batch so that dependent properties are recalculated once, in update order
+	FDynamicPropertiesContainerBatchScope ContainerBatch(this);
+
+	for (const TPair<FGameplayTag, UDynamicProperty*>& Pair : DynamicProperties)
+	{
+		if (Pair.Value)
+		{
+			Pair.Value->RefreshModifiers();
+		}
+	}
+
+	for (int32 Index = 0; Index < CompactProperties.Num(); ++Index)
+	{
+		CompactProperties.RefreshModifiers(Index);
+	}
+
+	RebuildPropertyInputs();
+
+	TArray<int32> ChangedIndices;
+	TArray<float> OldValues;
+	{
+		DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_RecalculateAll);
+		DYNAMIC_PROPERTIES_COUNT(Recalculations, this, FGameplayTag(), CompactProperties.Num());
+		CompactProperties.RecalculateAll(ChangedIndices, OldValues);
+	}
+
+	// Collect the tags first, change hooks may reorder compact storage
+	TArray<FGameplayTag, TInlineAllocator<16>> ChangedTags;
+	TArray<float, TInlineAllocator<16>> NewValues;
+	for (const int32 Index : ChangedIndices)
+	{
+		ChangedTags.Add(CompactProperties.GetTag(Index));
+		NewValues.Add(CompactProperties.GetValue(Index));
+	}
+
+	for (int32 ChangeIndex = 0; ChangeIndex < ChangedTags.Num(); ++ChangeIndex)
+	{
+		OnPropertyValueChangedInternal(ChangedTags[ChangeIndex], OldValues[ChangeIndex], NewValues[ChangeIndex]);
+	}
+}
+
+void UDynamicPropertiesContainer::SaveSnapshot(TArray<uint8>& OutData) const
+{
+	FDynamicPropertiesSnapshot::Save(*this, OutData);
+}
+
+bool UDynamicPropertiesContainer::LoadSnapshot(const TArray<uint8>& Data)
+{
+	return FDynamicPropertiesSnapshot::Load(*this, Data);
+}
+
+int32 UDynamicPropertiesContainer::InitializeFromPreset(const UDynamicPropertiesPreset* Preset)
+{
+	if (!Preset)
+	{
+		return 0;
+	}
+
+	if (IsBatching())
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("UDynamicPropertiesContainer::InitializeFromPreset - Cannot initialize a container while it is batching."));
+		return 0;
+	}
+
+	const TArray<FDynamicPropertyPresetEntry>& Entries = Preset->GetPropertiesInDepthOrder();
+
+	if (bUseCompactStorage)
+	{
+		CompactProperties.Reserve(CompactProperties.Num() + Entries.Num());
+	}
+	else
+	{
+		DynamicProperties.Reserve(DynamicProperties.Num() + Entries.Num());
+	}
+
+	// Insert without going through the per-property add path, derived state is updated once for all of them below
+	TArray<FGameplayTag> AddedTags;
+	AddedTags.Reserve(Entries.Num());
+
+	const bool bLazy = UsesLazyEvaluation();
+	for (const FDynamicPropertyPresetEntry& Entry : Entries)
+	{
+		if (HasProperty(Entry.PropertyTag))
+		{
+			continue;
+		}
+
+		if (bUseCompactStorage)
+		{
+			CompactProperties.Add(Entry.PropertyTag, Entry.BaseValue);
+		}
+		else
+		{
+			UDynamicProperty* Property = NewObject<UDynamicProperty>(this);
+			Property->BaseValue = Entry.BaseValue;
+			Property->Value = Entry.BaseValue;
+			Property->bLazyEvaluation = bLazy;
+			Property->CompileModifiers();
+
+			DynamicProperties.Add(Entry.PropertyTag, Property);
+			Property->SetOwningContainer(this, Entry.PropertyTag);
+		}
+
+		AddedTags.Add(Entry.PropertyTag);
+	}
+
+	OnPropertiesInitializedInternal(AddedTags);
+
+	return AddedTags.Num();
+}
+
+void UDynamicPropertiesContainer::OnPropertiesInitializedInternal(const TArray<FGameplayTag>& AddedTags)
+{
+	MarkReadViewDirty();
+
+	// Added lazy properties left dirty by derived classes are settled silently, nothing has seen a previous value of them
+	// and a later flush would report their initial value as a change
+	for (const FGameplayTag& PropertyTag : AddedTags)
+	{
+		UDynamicProperty* Property = FindPropertyObject(PropertyTag);
+		if (Property && Property->bValueDirty)
+		{
+			Property->bValueDirty = false;
+			Property->Value = Property->CalculateForBaseValue(Property->BaseValue);
+			DirtyPropertyTags.Remove(PropertyTag);
+		}
+	}
+
+	if (ShouldReplicateValues())
+	{
+		for (const FGameplayTag& PropertyTag : AddedTags)
+		{
+			float Value = 0.0f;
+			if (FindPropertyValue(PropertyTag, Value))
+			{
+				ReplicatePropertyValue(PropertyTag, Value);
+			}
+		}
+	}
+
+	// Existing properties may read the new ones, which no longer resolve to the default
+	for (const FGameplayTag& PropertyTag : AddedTags)
+	{
+		UpdateDependentProperties(PropertyTag);
+	}
+
+	if (OnPropertiesInitialized.IsBound())
+	{
+		OnPropertiesInitialized.Broadcast();
+	}
+}
+
+void UDynamicPropertiesContainer::OnPropertiesRestoredInternal()
+{
+	MarkReadViewDirty();
+	RebuildPropertyInputs();
+	RecalculateRestoredProperties();
+
+	// Clients are sent the restored set as a whole
+	if (ShouldReplicateValues())
+	{
+		ReplicatedValues.Reset();
+
+		TArray<FGameplayTag> PropertyTags;
+		GetPropertiesKeys(PropertyTags);
+		for (const FGameplayTag& PropertyTag : PropertyTags)
+		{
+			float Value = 0.0f;
+			if (FindPropertyValue(PropertyTag, Value))
+			{
+				ReplicatedValues.SetValue(PropertyTag, Value, ReplicationQuantization.FindRef(PropertyTag));
+			}
+		}
+
+		MARK_PROPERTY_DIRTY_FROM_NAME(UDynamicPropertiesContainer, ReplicatedValues, this);
+	}
+
+	if (OnPropertiesRestored.IsBound())
+	{
+		OnPropertiesRestored.Broadcast();
+	}
+}
+
+void UDynamicPropertiesContainer::RecalculateRestoredProperties()
+{
+	// Restored properties have no previous value to report a change from
+	auto RecalculateProperty = [](UDynamicProperty* Property)
+	{
+		Property->bValueDirty = false;
+		Property->bHasPrecomputedValue = false;
+		Property->Value = Property->CalculateForBaseValue(Property->BaseValue);
+	};
+
+	// Without inputs the order doesn't matter, compact properties are evaluated together by the batch kernel
+	if (PropertyInputs.Num() == 0)
+	{
+		TArray<int32> ChangedIndices;
+		TArray<float> OldValues;
+		CompactProperties.RecalculateAll(ChangedIndices, OldValues);
+
+		for (const TPair<FGameplayTag, UDynamicProperty*>& Pair : DynamicProperties)
+		{
+			if (Pair.Value)
+			{
+				RecalculateProperty(Pair.Value);
+			}
+		}
+		return;
+	}
+
+	// Each property is evaluated after every property its modifiers read
+	EnsureDependencyOrder();
+	TArray<FGameplayTag> OrderedTags;
+	GetPropertiesInUpdateOrder(OrderedTags);
+
+	for (const FGameplayTag& PropertyTag : OrderedTags)
+	{
+		if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+		{
+			RecalculateProperty(Property);
+		}
+		else
+		{
+			const int32 Index = CompactProperties.Find(PropertyTag).Index;
+			float OldValue = 0.0f;
+			if (Index != INDEX_NONE)
+			{
+				CompactProperties.Recalculate(Index, OldValue);
+			}
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::OnPropertyValueChangedInternal(FGameplayTag PropertyTag, float OldValue, float NewValue)
+{
+	if (ShouldReplicateValues())
+	{
+		ReplicatePropertyValue(PropertyTag, NewValue);
+	}
+
+	if (bCoalesceValueChanges)
+	{
+		CoalesceValueChange(PropertyTag, OldValue, NewValue);
+	}
+
+	MarkReadViewDirty();
+
+	// Base implementation broadcasts the event
+	if (OnPropertyValueChanged.IsBound())
+	{
+		DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_Broadcast);
+		DYNAMIC_PROPERTIES_COUNT(Broadcasts, this, PropertyTag, 1);
+		OnPropertyValueChanged.Broadcast(PropertyTag, OldValue, NewValue);
+	}
+
+	UpdateDependentProperties(PropertyTag);
+}
+
+void UDynamicPropertiesContainer::CoalesceValueChange(FGameplayTag PropertyTag, float OldValue, float NewValue)
+{
+	if (const int32* ChangeIndex = CoalescedChangeIndices.Find(PropertyTag))
+	{
+		CoalescedChanges[*ChangeIndex].NewValue = NewValue;
+		return;
+	}
+
+	CoalescedChangeIndices.Add(PropertyTag, CoalescedChanges.Num());
+	FDynamicPropertyCoalescedChange& Change = CoalescedChanges.AddDefaulted_GetRef();
+	Change.PropertyTag = PropertyTag;
+	Change.OldValue = OldValue;
+	Change.NewValue = NewValue;
+
+	if (!bRegisteredForCoalescedChanges)
+	{
+		UWorld* World = GetWorld();
+		if (UDynamicPropertiesSubsystem* Subsystem = World ? World->GetSubsystem<UDynamicPropertiesSubsystem>() : nullptr)
+		{
+			Subsystem->RegisterCoalescingContainer(this);
+			bRegisteredForCoalescedChanges = true;
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::FlushCoalescedValueChanges()
+{
+	bRegisteredForCoalescedChanges = false;
+
+	if (CoalescedChanges.Num() == 0)
+	{
+		return;
+	}
+
+	// Changes made by listeners are collected for the next broadcast
+	TArray<FDynamicPropertyCoalescedChange> Changes = MoveTemp(CoalescedChanges);
+	CoalescedChanges.Reset();
+	CoalescedChangeIndices.Reset();
+
+	Changes.RemoveAll([](const FDynamicPropertyCoalescedChange& Change)
+	{
+		return FMath::IsNearlyEqual(Change.OldValue, Change.NewValue);
+	});
+
+	if (Changes.Num() > 0 && OnPropertyValuesChangedThisFrame.IsBound())
+	{
+		DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_Broadcast);
+		DYNAMIC_PROPERTIES_COUNT(Broadcasts, this, FGameplayTag(), 1);
+		OnPropertyValuesChangedThisFrame.Broadcast(Changes);
+	}
+}
+
+TSharedRef<FDynamicPropertiesReadView, ESPMode::ThreadSafe> UDynamicPropertiesContainer::GetReadView()
+{
+	if (!ReadView.IsValid())
+	{
+		ReadView = MakeShared<FDynamicPropertiesReadView, ESPMode::ThreadSafe>();
+		bReadViewDirty = true;
+		PublishReadView();
+	}
+
+	return ReadView.ToSharedRef();
+}
+
+void UDynamicPropertiesContainer::PublishReadView()
+{
+	bRegisteredForReadViewPublish = false;
+
+	if (!ReadView.IsValid() || !bReadViewDirty)
+	{
+		return;
+	}
+
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_PublishReadView);
+
+	// Still dirty while values are gathered, so lazy properties flushed here don't queue another publish
+	TArray<FGameplayTag> PropertyTags;
+	GetPropertiesKeys(PropertyTags);
+
+	TMap<FGameplayTag, float> Values;
+	Values.Reserve(PropertyTags.Num());
+	for (const FGameplayTag& PropertyTag : PropertyTags)
+	{
+		float Value = 0.0f;
+		if (FindPropertyValue(PropertyTag, Value))
+		{
+			Values.Add(PropertyTag, Value);
+		}
+	}
+
+	bReadViewDirty = false;
+	ReadView->Publish(MoveTemp(Values));
+}
+
+void UDynamicPropertiesContainer::MarkReadViewDirty()
+{
+	if (!ReadView.IsValid() || bReadViewDirty)
+	{
+		return;
+	}
+
+	bReadViewDirty = true;
+
+	if (!bRegisteredForReadViewPublish)
+	{
+		UWorld* World = GetWorld();
+		if (UDynamicPropertiesSubsystem* Subsystem = World ? World->GetSubsystem<UDynamicPropertiesSubsystem>() : nullptr)
+		{
+			Subsystem->RegisterPublishingContainer(this);
+			bRegisteredForReadViewPublish = true;
+		}
+	}
+}
+
+float UDynamicPropertiesContainer::GetPropertyValueOrDefault(FGameplayTag PropertyTag, float DefaultValue)
+{
+	float Value = DefaultValue;
+	FindPropertyValue(PropertyTag, Value);
+	return Value;
+}
+
+bool UDynamicPropertiesContainer::FindPropertyValue(FGameplayTag PropertyTag, float& OutValue) const
+{
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		OutValue = Property->GetValue();
+		return true;
+	}
+
+	const int32 Index = CompactProperties.Find(PropertyTag).Index;
+	if (Index != INDEX_NONE)
+	{
+		OutValue = CompactProperties.GetValue(Index);
+		return true;
+	}
+
+	return false;
+}
+
+FDynamicPropertiesMemoryStats& FDynamicPropertiesMemoryStats::operator+=(const FDynamicPropertiesMemoryStats& Other)
+{
+	NumContainers += Other.NumContainers;
+	NumPropertyObjects += Other.NumPropertyObjects;
+	NumCompactProperties += Other.NumCompactProperties;
+	NumModifierObjects += Other.NumModifierObjects;
+	NumStructModifiers += Other.NumStructModifiers;
+	NumContainerBindings += Other.NumContainerBindings;
+	NumPropertyBindings += Other.NumPropertyBindings;
+	ContainerBytes += Other.ContainerBytes;
+	PropertyBytes += Other.PropertyBytes;
+	ModifierBytes += Other.ModifierBytes;
+	return *this;
+}
+
+SIZE_T UDynamicPropertiesContainer::GetAllocatedSize() const
+{
+	SIZE_T Size = CompactProperties.GetAllocatedSize()
+		+ ReplicatedValues.GetAllocatedSize()
+		+ DirtyPropertyTags.GetAllocatedSize()
+		+ PropertyInputs.GetAllocatedSize()
+		+ PropertyDependents.GetAllocatedSize()
+		+ DependencyRanks.GetAllocatedSize()
+		+ CyclicPropertyTags.GetAllocatedSize()
+		+ PendingDependents.GetAllocatedSize()
+		+ QueuedDependents.GetAllocatedSize()
+		+ CoalescedChanges.GetAllocatedSize()
+		+ CoalescedChangeIndices.GetAllocatedSize();
+
+	for (const TPair<FGameplayTag, TArray<FGameplayTag>>& Pair : PropertyInputs)
+	{
+		Size += Pair.Value.GetAllocatedSize();
+	}
+	for (const TPair<FGameplayTag, TArray<FGameplayTag>>& Pair : PropertyDependents)
+	{
+		Size += Pair.Value.GetAllocatedSize();
+	}
+
+	if (ReadView.IsValid())
+	{
+		Size += ReadView->GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+void UDynamicPropertiesContainer::AccumulateMemoryStats(FDynamicPropertiesMemoryStats& Stats, TSet<const UModifier*>& CountedModifiers) const
+{
+	// Class size for the object itself, the counting archive for everything it holds
+	auto GetObjectBytes = [](const UObject* Object) -> SIZE_T
+	{
+		FArchiveCountMem CountMem(const_cast<UObject*>(Object));
+		return Object->GetClass()->GetStructureSize() + CountMem.GetMax();
+	};
+
+	auto CountModifier = [&Stats, &CountedModifiers, &GetObjectBytes](const UModifier* Modifier)
+	{
+		// Shared modifiers are counted along with the modifier they wrap
+		while (Modifier)
+		{
+			bool bAlreadyCounted = false;
+			CountedModifiers.Add(Modifier, &bAlreadyCounted);
+			if (bAlreadyCounted)
+			{
+				return;
+			}
+
+			++Stats.NumModifierObjects;
+			Stats.ModifierBytes += GetObjectBytes(Modifier);
+
+			const USharedModifier* SharedModifier = Cast<USharedModifier>(Modifier);
+			Modifier = SharedModifier ? SharedModifier->GetModifier() : nullptr;
+		}
+	};
+
+	++Stats.NumContainers;
+	Stats.ContainerBytes += GetObjectBytes(this);
+	Stats.NumContainerBindings += OnPropertyValueChanged.GetAllObjects().Num()
+		+ OnPropertyValuesChangedThisFrame.GetAllObjects().Num()
+		+ OnPropertiesRestored.GetAllObjects().Num()
+		+ OnPropertiesInitialized.GetAllObjects().Num();
+
+	for (const TPair<FGameplayTag, UDynamicProperty*>& Pair : DynamicProperties)
+	{
+		const UDynamicProperty* Property = Pair.Value;
+		if (!Property)
+		{
+			continue;
+		}
+
+		++Stats.NumPropertyObjects;
+		Stats.PropertyBytes += GetObjectBytes(Property);
+		Stats.NumPropertyBindings += Property->ValueChanged.GetAllObjects().Num();
+		Stats.NumStructModifiers += Property->StructModifiers.Num();
+
+		for (const UModifier* Modifier : Property->Modifiers)
+		{
+			CountModifier(Modifier);
+		}
+	}
+
+	Stats.NumCompactProperties += CompactProperties.Num();
+
+	TArray<UModifier*> CompactModifiers;
+	for (int32 Index = 0; Index < CompactProperties.Num(); ++Index)
+	{
+		CompactModifiers.Reset();
+		CompactProperties.GetModifiers(Index, CompactModifiers);
+		for (const UModifier* Modifier : CompactModifiers)
+		{
+			CountModifier(Modifier);
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::GetPropertiesKeys(TArray<FGameplayTag>& OutKeys)
+{
+	DynamicProperties.GetKeys(OutKeys);
+	OutKeys.Append(CompactProperties.GetTags());
+}
+
+void UDynamicPropertiesContainer::BeginBatch()
+{
+	if (BatchDepth++ > 0)
+	{
+		return;
+	}
+
+	for (const TPair<FGameplayTag, UDynamicProperty*>& Pair : DynamicProperties)
+	{
+		if (Pair.Value)
+		{
+			Pair.Value->BeginBatch();
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::EndBatch()
+{
+	if (BatchDepth <= 0)
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("UDynamicPropertiesContainer::EndBatch - Called without matching BeginBatch. Ignoring."));
+		return;
+	}
+
+	if (--BatchDepth > 0)
+	{
+		return;
+	}
+
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_EndBatch);
+
+	// Properties are committed in update order so that changes made by earlier ones are folded into later ones
+	EnsureDependencyOrder();
+	TArray<FGameplayTag> OrderedTags;
+	GetPropertiesInUpdateOrder(OrderedTags);
+
+	for (const FGameplayTag& PropertyTag : OrderedTags)
+	{
+		if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+		{
+			Property->EndBatch();
+		}
+		else
+		{
+			const int32 Index = CompactProperties.Find(PropertyTag).Index;
+			if (Index != INDEX_NONE && CompactProperties.ConsumeDirty(Index))
+			{
+				ApplyCompactPropertyChange(Index);
+			}
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::GetPropertiesInUpdateOrder(TArray<FGameplayTag>& OutTags) const
+{
+	DynamicProperties.GetKeys(OutTags);
+	OutTags.Append(CompactProperties.GetTags());
+
+	// Properties come after every property their modifiers read
+	if (PropertyInputs.Num() > 0 && !bDependencyOrderDirty)
+	{
+		Algo::StableSortBy(OutTags, [this](const FGameplayTag& PropertyTag)
+		{
+			return DependencyRanks.FindRef(PropertyTag);
+		});
+	}
+}
+
+void UDynamicPropertiesContainer::OnPropertyAddedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property)
+{
+	MarkReadViewDirty();
+	UpdatePropertyInputs(PropertyTag);
+
+	// Properties reading this one no longer read the default
+	UpdateDependentProperties(PropertyTag);
+
+	const bool bReplicate = ShouldReplicateValues();
+	if (!bReplicate && !OnPropertyValueChanged.IsBound())
+	{
+		return;
+	}
+
+	float InitialValue = 0.0f;
+	if (!FindPropertyValue(PropertyTag, InitialValue))
+	{
+		return;
+	}
+
+	if (bReplicate)
+	{
+		ReplicatePropertyValue(PropertyTag, InitialValue);
+	}
+
+	// Fire value changed event for the initial value (transition from non-existent to existent)
+	if (OnPropertyValueChanged.IsBound())
+	{
+		OnPropertyValueChanged.Broadcast(PropertyTag, InitialValue, InitialValue);
+	}
+}
+
+void UDynamicPropertiesContainer::OnPropertyRemovedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property)
+{
+	MarkReadViewDirty();
+
+	if (PropertyInputs.Remove(PropertyTag) > 0)
+	{
+		bDependencyOrderDirty = true;
+	}
+	UpdateDependentProperties(PropertyTag);
+
+	if (ShouldReplicateValues() && ReplicatedValues.RemoveValue(PropertyTag))
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UDynamicPropertiesContainer, ReplicatedValues, this);
+	}
+}
+
+bool UDynamicPropertiesContainer::ShouldReplicateValues() const
+{
+	const AActor* Owner = GetOwner();
+	return GetIsReplicated() && Owner && Owner->HasAuthority();
+}
+
+void UDynamicPropertiesContainer::ReplicatePropertyValue(FGameplayTag PropertyTag, float Value)
+{
+	const EDynamicPropertyQuantization* Quantization = ReplicationQuantization.Find(PropertyTag);
+	if (ReplicatedValues.SetValue(PropertyTag, Value, Quantization ? *Quantization : EDynamicPropertyQuantization::None))
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UDynamicPropertiesContainer, ReplicatedValues, this);
+	}
+}
+
+void UDynamicPropertiesContainer::HandleReplicatedValue(FGameplayTag PropertyTag, float Value)
+{
+	TGuardValue<bool> ApplyingGuard(bApplyingReplicatedValues, true);
+
+	if (!HasProperty(PropertyTag))
+	{
+		AddProperty(PropertyTag, Value);
+		return;
+	}
+
+	// The server value replaces the local one as is, modifiers were already applied on the server
+	float OldValue = 0.0f;
+	if (UDynamicProperty* Property = FindPropertyObject(PropertyTag))
+	{
+		OldValue = Property->Value;
+		Property->Value = Value;
+		Property->bValueDirty = false;
+		Property->bHasPrecomputedValue = false;
+
+		if (!FMath::IsNearlyEqual(OldValue, Value))
+		{
+			OnPropertyValueChangedInternal(PropertyTag, OldValue, Value);
+			Property->BroadcastValueChanged(OldValue, Value);
+		}
+		return;
+	}
+
+	const int32 Index = CompactProperties.Find(PropertyTag).Index;
+	if (Index != INDEX_NONE)
+	{
+		OldValue = CompactProperties.GetValue(Index);
+		CompactProperties.SetValue(Index, Value);
+
+		if (!FMath::IsNearlyEqual(OldValue, Value))
+		{
+			OnPropertyValueChangedInternal(PropertyTag, OldValue, Value);
+		}
+	}
+}
+
+void UDynamicPropertiesContainer::HandleReplicatedRemove(FGameplayTag PropertyTag)
+{
+	TGuardValue<bool> ApplyingGuard(bApplyingReplicatedValues, true);
+	RemoveProperty(PropertyTag);
+}
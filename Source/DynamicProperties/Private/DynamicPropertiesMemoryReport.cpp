@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "DynamicPropertiesContainer.h"
+#include "DynamicPropertiesLog.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+namespace DynamicPropertiesMemoryReport
+{
+	/** Totals of one container class in one world */
+	struct FRow
+	{
+		FString World;
+		FString ContainerClass;
+		FDynamicPropertiesMemoryStats Stats;
+	};
+
+	FString FormatRow(const FString& Name, const FDynamicPropertiesMemoryStats& Stats)
+	{
+		return FString::Printf(TEXT("  %-40s %10d %10d %10d %10d %10d %10d %10d %12.1f"),
+			*Name, Stats.NumContainers, Stats.NumPropertyObjects, Stats.NumCompactProperties, Stats.NumModifierObjects,
+			Stats.NumStructModifiers, Stats.NumContainerBindings, Stats.NumPropertyBindings, Stats.GetTotalBytes() / 1024.0);
+	}
+
+	void WriteCsv(const TArray<FRow>& Rows)
+	{
+		FString Csv = TEXT("World,ContainerClass,Containers,PropertyObjects,CompactProperties,ModifierObjects,StructModifiers,ContainerBindings,PropertyBindings,ContainerBytes,PropertyBytes,ModifierBytes,TotalBytes\n");
+		for (const FRow& Row : Rows)
+		{
+			const FDynamicPropertiesMemoryStats& Stats = Row.Stats;
+			Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%d,%d,%d,%d,%llu,%llu,%llu,%llu\n"),
+				*Row.World, *Row.ContainerClass, Stats.NumContainers, Stats.NumPropertyObjects, Stats.NumCompactProperties,
+				Stats.NumModifierObjects, Stats.NumStructModifiers, Stats.NumContainerBindings, Stats.NumPropertyBindings,
+				static_cast<uint64>(Stats.ContainerBytes), static_cast<uint64>(Stats.PropertyBytes), static_cast<uint64>(Stats.ModifierBytes),
+				static_cast<uint64>(Stats.GetTotalBytes()));
+		}
+
+		const FString FilePath = FPaths::ProfilingDir() / TEXT("DynamicProperties") / FString::Printf(TEXT("Memory-%s.csv"), *FDateTime::Now().ToString());
+		if (FFileHelper::SaveStringToFile(Csv, *FilePath))
+		{
+			UE_LOG(LogDynamicProperties, Display, TEXT("DynamicProperties.MemReport - Results written to %s"), *FilePath);
+		}
+	}
+
+	void Run(const TArray<FString>& Args)
+	{
+		// Modifiers shared between containers of a world are counted once for that world
+		TMap<const UWorld*, TMap<const UClass*, FDynamicPropertiesMemoryStats>> StatsByWorld;
+		TMap<const UWorld*, TSet<const UModifier*>> CountedModifiersByWorld;
+
+		for (TObjectIterator<UDynamicPropertiesContainer> It; It; ++It)
+		{
+			const UDynamicPropertiesContainer* Container = *It;
+			if (Container->IsTemplate())
+			{
+				continue;
+			}
+
+			const UWorld* World = Container->GetWorld();
+			FDynamicPropertiesMemoryStats& Stats = StatsByWorld.FindOrAdd(World).FindOrAdd(Container->GetClass());
+			Container->AccumulateMemoryStats(Stats, CountedModifiersByWorld.FindOrAdd(World));
+		}
+
+		if (StatsByWorld.Num() == 0)
+		{
+			UE_LOG(LogDynamicProperties, Display, TEXT("DynamicProperties.MemReport - No containers found."));
+			return;
+		}
+
+		TArray<FRow> Rows;
+		FDynamicPropertiesMemoryStats GrandTotal;
+		for (const TPair<const UWorld*, TMap<const UClass*, FDynamicPropertiesMemoryStats>>& WorldPair : StatsByWorld)
+		{
+			const FString WorldName = WorldPair.Key ? WorldPair.Key->GetName() : FString(TEXT("<no world>"));
+			UE_LOG(LogDynamicProperties, Display, TEXT("Dynamic properties in %s (containers, property objects, compact properties, modifier objects, struct modifiers, container bindings, property bindings, KB):"), *WorldName);
+
+			FDynamicPropertiesMemoryStats WorldTotal;
+			for (const TPair<const UClass*, FDynamicPropertiesMemoryStats>& ClassPair : WorldPair.Value)
+			{
+				FRow& Row = Rows.AddDefaulted_GetRef();
+				Row.World = WorldName;
+				Row.ContainerClass = ClassPair.Key->GetName();
+				Row.Stats = ClassPair.Value;
+
+				UE_LOG(LogDynamicProperties, Display, TEXT("%s"), *FormatRow(Row.ContainerClass, ClassPair.Value));
+				WorldTotal += ClassPair.Value;
+			}
+
+			UE_LOG(LogDynamicProperties, Display, TEXT("%s"), *FormatRow(TEXT("Total"), WorldTotal));
+			GrandTotal += WorldTotal;
+		}
+
+		UE_LOG(LogDynamicProperties, Display, TEXT("DynamicProperties.MemReport - %d containers, %llu bytes in total."), GrandTotal.NumContainers, static_cast<uint64>(GrandTotal.GetTotalBytes()));
+		UE_LOG(LogDynamicProperties, Display, TEXT("DynamicProperties.MemReport - Properties notify their container directly, there are no value changed binder objects to count."));
+
+		if (Args.Contains(TEXT("csv")))
+		{
+			WriteCsv(Rows);
+		}
+	}
+}
+
+static FAutoConsoleCommand DynamicPropertiesMemReportCommand(
+	TEXT("DynamicProperties.MemReport"),
+	TEXT("Prints the containers, property objects, modifiers, delegate bindings and memory of dynamic properties per world and container class. Usage: DynamicProperties.MemReport [csv]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&DynamicPropertiesMemoryReport::Run));
+
+#endif
@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertiesPreset.h"
+#include "DynamicPropertiesLog.h"
+#include "Algo/StableSort.h"
+
+#if WITH_EDITOR
+void UDynamicPropertiesPreset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bSortedPropertiesValid = false;
+}
+#endif
+
+const TArray<FDynamicPropertyPresetEntry>& UDynamicPropertiesPreset::GetPropertiesInDepthOrder() const
+{
+	if (bSortedPropertiesValid)
+	{
+		return SortedProperties;
+	}
+
+	// Depth is the number of separators in the tag name, paired with the index of the entry
+	TArray<TPair<int32, int32>> Order;
+	Order.Reserve(Properties.Num());
+
+	TSet<FGameplayTag> SeenTags;
+	for (int32 Index = 0; Index < Properties.Num(); ++Index)
+	{
+		const FGameplayTag PropertyTag = Properties[Index].PropertyTag;
+		if (!PropertyTag.IsValid())
+		{
+			continue;
+		}
+
+		bool bAlreadySeen = false;
+		SeenTags.Add(PropertyTag, &bAlreadySeen);
+		if (bAlreadySeen)
+		{
+			UE_LOG(LogDynamicProperties, Warning, TEXT("UDynamicPropertiesPreset::GetPropertiesInDepthOrder - Property %s is listed more than once in %s. Only the first entry is used."), *PropertyTag.ToString(), *GetPathName());
+			continue;
+		}
+
+		int32 Depth = 0;
+		for (const TCHAR Character : PropertyTag.ToString())
+		{
+			Depth += Character == TEXT('.') ? 1 : 0;
+		}
+		Order.Emplace(Depth, Index);
+	}
+
+	Algo::StableSortBy(Order, [](const TPair<int32, int32>& Entry)
+	{
+		return Entry.Key;
+	});
+
+	SortedProperties.Reset(Order.Num());
+	for (const TPair<int32, int32>& Entry : Order)
+	{
+		SortedProperties.Add(Properties[Entry.Value]);
+	}
+
+	bSortedPropertiesValid = true;
+	return SortedProperties;
+}
@@ -0,0 +1,140 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertiesReadView.h"
+
+FDynamicPropertiesValueSnapshotRef::FDynamicPropertiesValueSnapshotRef(TSharedPtr<const FDynamicPropertiesReadView, ESPMode::ThreadSafe> InView, const FDynamicPropertiesValueSnapshot* InSnapshot)
+	: View(MoveTemp(InView))
+	, Snapshot(InSnapshot)
+{
+	// The reference count was taken by Acquire
+}
+
+FDynamicPropertiesValueSnapshotRef::FDynamicPropertiesValueSnapshotRef(const FDynamicPropertiesValueSnapshotRef& Other)
+	: View(Other.View)
+	, Snapshot(Other.Snapshot)
+{
+	if (Snapshot)
+	{
+		Snapshot->NumReferences.fetch_add(1);
+	}
+}
+
+FDynamicPropertiesValueSnapshotRef& FDynamicPropertiesValueSnapshotRef::operator=(const FDynamicPropertiesValueSnapshotRef& Other)
+{
+	if (this != &Other)
+	{
+		if (Other.Snapshot)
+		{
+			Other.Snapshot->NumReferences.fetch_add(1);
+		}
+
+		Release();
+		View = Other.View;
+		Snapshot = Other.Snapshot;
+	}
+	return *this;
+}
+
+FDynamicPropertiesValueSnapshotRef::~FDynamicPropertiesValueSnapshotRef()
+{
+	Release();
+}
+
+void FDynamicPropertiesValueSnapshotRef::Release()
+{
+	// The snapshot memory is freed by the view on the game thread, the count only has to drop
+	if (Snapshot)
+	{
+		Snapshot->NumReferences.fetch_sub(1);
+		Snapshot = nullptr;
+	}
+	View.Reset();
+}
+
+FDynamicPropertiesReadView::~FDynamicPropertiesReadView()
+{
+	// References keep the view alive, so no reader is left at this point
+	delete Current.load();
+	for (FDynamicPropertiesValueSnapshot* Snapshot : Retired)
+	{
+		delete Snapshot;
+	}
+}
+
+FDynamicPropertiesValueSnapshotRef FDynamicPropertiesReadView::Acquire() const
+{
+	// While NumAcquiring is raised the game thread frees no retired snapshot, so the one loaded here
+	// stays alive until its reference count is taken
+	NumAcquiring.fetch_add(1);
+	const FDynamicPropertiesValueSnapshot* Snapshot = Current.load();
+	if (Snapshot)
+	{
+		Snapshot->NumReferences.fetch_add(1);
+	}
+	NumAcquiring.fetch_sub(1);
+
+	if (!Snapshot)
+	{
+		return FDynamicPropertiesValueSnapshotRef();
+	}
+
+	return FDynamicPropertiesValueSnapshotRef(AsShared(), Snapshot);
+}
+
+float FDynamicPropertiesReadView::GetValueOrDefault(FGameplayTag PropertyTag, float DefaultValue) const
+{
+	const FDynamicPropertiesValueSnapshotRef Snapshot = Acquire();
+	return Snapshot.IsValid() ? Snapshot->GetValueOrDefault(PropertyTag, DefaultValue) : DefaultValue;
+}
+
+void FDynamicPropertiesReadView::Publish(TMap<FGameplayTag, float>&& Values)
+{
+	check(IsInGameThread());
+
+	FDynamicPropertiesValueSnapshot* Snapshot = new FDynamicPropertiesValueSnapshot();
+	Snapshot->Values = MoveTemp(Values);
+	Snapshot->Version = NextVersion++;
+
+	if (FDynamicPropertiesValueSnapshot* Previous = Current.exchange(Snapshot))
+	{
+		Retired.Add(Previous);
+	}
+
+	CollectRetiredSnapshots();
+}
+
+SIZE_T FDynamicPropertiesReadView::GetAllocatedSize() const
+{
+	check(IsInGameThread());
+
+	SIZE_T Size = sizeof(FDynamicPropertiesReadView) + Retired.GetAllocatedSize();
+	if (const FDynamicPropertiesValueSnapshot* Snapshot = Current.load())
+	{
+		Size += sizeof(FDynamicPropertiesValueSnapshot) + Snapshot->Values.GetAllocatedSize();
+	}
+	for (const FDynamicPropertiesValueSnapshot* Snapshot : Retired)
+	{
+		Size += sizeof(FDynamicPropertiesValueSnapshot) + Snapshot->Values.GetAllocatedSize();
+	}
+	return Size;
+}
+
+void FDynamicPropertiesReadView::CollectRetiredSnapshots()
+{
+	check(IsInGameThread());
+
+	// A reader in the middle of Acquire may still be about to reference any retired snapshot, try again later
+	if (Retired.Num() == 0 || NumAcquiring.load() != 0)
+	{
+		return;
+	}
+
+	for (int32 Index = Retired.Num() - 1; Index >= 0; --Index)
+	{
+		if (Retired[Index]->NumReferences.load() == 0)
+		{
+			delete Retired[Index];
+			Retired.RemoveAtSwap(Index);
+		}
+	}
+}
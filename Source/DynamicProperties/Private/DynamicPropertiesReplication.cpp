@@ -0,0 +1,175 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertiesReplication.h"
+#include "DynamicPropertiesContainer.h"
+#include "GameplayTagsManager.h"
+
+namespace DynamicPropertiesReplication
+{
+	/** Number of bits used to send the quantization mode */
+	constexpr uint32 QuantizationBits = 2;
+
+	/** Largest number of steps sent quantized, larger values would overflow the zigzag encoding */
+	constexpr float MaxQuantizedSteps = static_cast<float>(1 << 30);
+
+	/** Number of steps per unit for each quantization mode */
+	float GetQuantizationScale(EDynamicPropertyQuantization Quantization)
+	{
+		switch (Quantization)
+		{
+		case EDynamicPropertyQuantization::Hundredths:
+			return 100.0f;
+		case EDynamicPropertyQuantization::Tenths:
+			return 10.0f;
+		default:
+			return 1.0f;
+		}
+	}
+
+	/**
+	 * Gets the precision a value is actually sent with
+	 * Values too large for their quantization, and non-finite ones, are sent at full precision instead
+	 */
+	EDynamicPropertyQuantization GetEffectiveQuantization(float Value, EDynamicPropertyQuantization Quantization)
+	{
+		if (Quantization == EDynamicPropertyQuantization::None)
+		{
+			return Quantization;
+		}
+
+		// Also false for NaN
+		return FMath::Abs(Value * GetQuantizationScale(Quantization)) < MaxQuantizedSteps ? Quantization : EDynamicPropertyQuantization::None;
+	}
+}
+
+bool FDynamicPropertyReplicatedItem::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace DynamicPropertiesReplication;
+
+	// Tags are sent as their network index instead of their name
+	UGameplayTagsManager& TagsManager = UGameplayTagsManager::Get();
+	uint32 NetIndex = Ar.IsSaving() ? TagsManager.GetNetIndexFromTag(PropertyTag) : 0;
+	Ar.SerializeIntPacked(NetIndex);
+
+	// The mode actually used is sent, the sender's item keeps the requested one
+	const EDynamicPropertyQuantization SentQuantization = Ar.IsSaving() ? GetEffectiveQuantization(Value, Quantization) : Quantization;
+	uint8 QuantizationValue = static_cast<uint8>(SentQuantization);
+	Ar.SerializeBits(&QuantizationValue, QuantizationBits);
+
+	if (Ar.IsLoading())
+	{
+		PropertyTag = TagsManager.GetTagFromNetIndex(static_cast<FGameplayTagNetIndex>(NetIndex));
+		Quantization = static_cast<EDynamicPropertyQuantization>(QuantizationValue);
+	}
+
+	if ((Ar.IsSaving() ? SentQuantization : Quantization) == EDynamicPropertyQuantization::None)
+	{
+		Ar << Value;
+	}
+	else
+	{
+		// Quantized values are sent as zigzag encoded packed integers, small magnitudes take a single byte
+		const float Scale = GetQuantizationScale(Quantization);
+		const int32 Steps = Ar.IsSaving() ? FMath::RoundToInt(Value * Scale) : 0;
+		uint32 Encoded = (static_cast<uint32>(Steps) << 1) ^ static_cast<uint32>(Steps >> 31);
+		Ar.SerializeIntPacked(Encoded);
+
+		if (Ar.IsLoading())
+		{
+			const int32 DecodedSteps = static_cast<int32>(Encoded >> 1) ^ -static_cast<int32>(Encoded & 1);
+			Value = DecodedSteps / Scale;
+		}
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+float FDynamicPropertyReplicatedItem::Quantize(float InValue, EDynamicPropertyQuantization InQuantization)
+{
+	if (DynamicPropertiesReplication::GetEffectiveQuantization(InValue, InQuantization) == EDynamicPropertyQuantization::None)
+	{
+		return InValue;
+	}
+
+	const float Scale = DynamicPropertiesReplication::GetQuantizationScale(InQuantization);
+	return FMath::RoundToInt(InValue * Scale) / Scale;
+}
+
+void FDynamicPropertyReplicatedItem::PostReplicatedAdd(const FDynamicPropertiesReplicatedValues& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HandleReplicatedValue(PropertyTag, Value);
+	}
+}
+
+void FDynamicPropertyReplicatedItem::PostReplicatedChange(const FDynamicPropertiesReplicatedValues& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HandleReplicatedValue(PropertyTag, Value);
+	}
+}
+
+void FDynamicPropertyReplicatedItem::PreReplicatedRemove(const FDynamicPropertiesReplicatedValues& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HandleReplicatedRemove(PropertyTag);
+	}
+}
+
+bool FDynamicPropertiesReplicatedValues::SetValue(FGameplayTag PropertyTag, float Value, EDynamicPropertyQuantization Quantization)
+{
+	if (const int32* Index = ItemIndices.Find(PropertyTag))
+	{
+		FDynamicPropertyReplicatedItem& Item = Items[*Index];
+
+		// Changes below the sent precision don't cost any bandwidth, the item keeps the last sent value to compare against
+		if (Item.Quantization == Quantization
+			&& FDynamicPropertyReplicatedItem::Quantize(Item.Value, Quantization) == FDynamicPropertyReplicatedItem::Quantize(Value, Quantization))
+		{
+			return false;
+		}
+
+		Item.Value = Value;
+		Item.Quantization = Quantization;
+		MarkItemDirty(Item);
+		return true;
+	}
+
+	FDynamicPropertyReplicatedItem& NewItem = Items.AddDefaulted_GetRef();
+	NewItem.PropertyTag = PropertyTag;
+	NewItem.Value = Value;
+	NewItem.Quantization = Quantization;
+	ItemIndices.Add(PropertyTag, Items.Num() - 1);
+	MarkItemDirty(NewItem);
+
+	return true;
+}
+
+bool FDynamicPropertiesReplicatedValues::RemoveValue(FGameplayTag PropertyTag)
+{
+	int32 Index = INDEX_NONE;
+	if (!ItemIndices.RemoveAndCopyValue(PropertyTag, Index))
+	{
+		return false;
+	}
+
+	Items.RemoveAtSwap(Index);
+	if (Items.IsValidIndex(Index))
+	{
+		ItemIndices.Add(Items[Index].PropertyTag, Index);
+	}
+
+	MarkArrayDirty();
+	return true;
+}
+
+void FDynamicPropertiesReplicatedValues::Reset()
+{
+	Items.Reset();
+	ItemIndices.Reset();
+	MarkArrayDirty();
+}
@@ -0,0 +1,581 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertiesSnapshot.h"
+#include "DynamicPropertiesLog.h"
+#include "DynamicPropertiesContainer.h"
+#include "DynamicPropertiesSubsystem.h"
+#include "SharedModifier.h"
+#include "Engine/World.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "InstancedStruct.h"
+
+namespace DynamicPropertiesSnapshot
+{
+	/** Identifies snapshot data */
+	constexpr uint32 Magic = 0x4E535044; // 'DPSN'
+
+	/** Property flag: the property is kept in compact storage */
+	constexpr uint8 PropertyFlag_Compact = 1 << 0;
+
+	/** Type index of a modifier object saved as a reference to a shared modifier, its payload is the object path */
+	constexpr int32 SharedModifierReference = -2;
+
+	/** Fewest bytes a property takes: tag index, flags, base value, modifier object count and struct modifier count */
+	constexpr int64 MinPropertySize = sizeof(int32) + sizeof(uint8) + sizeof(float) + sizeof(int32) + sizeof(int32);
+
+	/** Struct modifier kinds */
+	constexpr uint8 StructModifier_Linear = 0;
+	constexpr uint8 StructModifier_Instanced = 1;
+
+	/** Builds a table of unique values, referenced by index */
+	template <typename ValueType>
+	struct TIndexTable
+	{
+		TArray<ValueType> Values;
+		TMap<ValueType, int32> Indices;
+
+		int32 FindOrAdd(const ValueType& Value)
+		{
+			if (const int32* Index = Indices.Find(Value))
+			{
+				return *Index;
+			}
+			return Indices.Add(Value, Values.Add(Value));
+		}
+	};
+
+	/** Source and lifetime of an applied modifier read from a snapshot */
+	struct FLoadedModifierState
+	{
+		/** Object the modifier was added on behalf of, nullptr if none or if it no longer exists */
+		UObject* Source = nullptr;
+
+		/** Remaining lifetime of a timed modifier in seconds, negative if it doesn't expire */
+		float RemainingDuration = -1.0f;
+	};
+
+	/** A struct modifier read from a snapshot */
+	struct FLoadedStructModifier
+	{
+		int32 Priority = 0;
+		FLoadedModifierState State;
+		FModifierLinearOp Op;
+		FInstancedStruct Instance;
+	};
+
+	/** A modifier object read from a snapshot, created only once the whole snapshot is valid */
+	struct FLoadedObject
+	{
+		/** Class of a modifier copied into the container, nullptr if the class is unknown */
+		const UClass* Class = nullptr;
+
+		/** Tagged property payload of a copied modifier */
+		TArray<uint8> Payload;
+
+		/** Shared modifier the property subscribes to again, instead of a copy */
+		USharedModifier* SharedModifier = nullptr;
+
+		bool IsValid() const { return Class || SharedModifier; }
+	};
+
+	/** A property read from a snapshot */
+	struct FLoadedProperty
+	{
+		FGameplayTag Tag;
+		uint8 Flags = 0;
+		float BaseValue = 0.0f;
+
+		/** Indices into the loaded objects, in application order */
+		TArray<int32> ObjectIndices;
+
+		/** Source and lifetime of each modifier object, parallel to ObjectIndices */
+		TArray<FLoadedModifierState> ObjectStates;
+
+		TArray<FLoadedStructModifier> StructModifiers;
+	};
+
+	void WriteStructPayload(const UScriptStruct* Type, const void* Memory, TArray<uint8>& OutPayload)
+	{
+		FMemoryWriter PayloadWriter(OutPayload);
+		FObjectAndNameAsStringProxyArchive PayloadArchive(PayloadWriter, false);
+		const_cast<UScriptStruct*>(Type)->SerializeItem(PayloadArchive, const_cast<void*>(Memory), nullptr);
+	}
+
+	void ReadModifierState(FArchive& Reader, uint32 SnapshotVersion, FLoadedModifierState& OutState)
+	{
+		if (SnapshotVersion < 3)
+		{
+			return;
+		}
+
+		FString SourcePath;
+		Reader << SourcePath << OutState.RemainingDuration;
+
+		// Like shared modifiers, sources are looked up and never loaded
+		if (!SourcePath.IsEmpty() && !Reader.IsError())
+		{
+			OutState.Source = FindObject<UObject>(nullptr, *SourcePath);
+			if (!OutState.Source)
+			{
+				UE_LOG(LogDynamicProperties, Warning, TEXT("FDynamicPropertiesSnapshot::Load - Modifier source %s no longer exists, the modifier is restored without it."), *SourcePath);
+			}
+		}
+	}
+
+	void ReadStructPayload(const UScriptStruct* Type, void* Memory, const TArray<uint8>& Payload)
+	{
+		FMemoryReader PayloadReader(Payload);
+		FObjectAndNameAsStringProxyArchive PayloadArchive(PayloadReader, true);
+		const_cast<UScriptStruct*>(Type)->SerializeItem(PayloadArchive, Memory, nullptr);
+	}
+}
+
+void FDynamicPropertiesSnapshot::Save(const UDynamicPropertiesContainer& Container, TArray<uint8>& OutData)
+{
+	using namespace DynamicPropertiesSnapshot;
+
+	TIndexTable<FName> TagTable;
+	TIndexTable<const UStruct*> TypeTable;
+	TIndexTable<UModifier*> ObjectTable;
+
+	// Properties are written to their own buffer first, since they fill the tables
+	TArray<uint8> PropertyData;
+	FMemoryWriter PropertyWriter(PropertyData);
+
+	int32 NumProperties = Container.DynamicProperties.Num() + Container.CompactProperties.Num();
+	PropertyWriter << NumProperties;
+
+	// Timed modifiers are saved with the time they have left
+	TMap<TPair<const UDynamicProperty*, FModifierHandle>, float> RemainingDurations;
+	const UWorld* World = Container.GetWorld();
+	if (const UDynamicPropertiesSubsystem* Subsystem = World ? World->GetSubsystem<UDynamicPropertiesSubsystem>() : nullptr)
+	{
+		Subsystem->GetRemainingModifierDurations(&Container, RemainingDurations);
+	}
+
+	auto WriteModifierState = [&PropertyWriter, &RemainingDurations](const UDynamicProperty* Property, int32 SlotIndex)
+	{
+		FString SourcePath;
+		float RemainingDuration = -1.0f;
+		if (Property && Property->ModifierSlots.IsValidIndex(SlotIndex))
+		{
+			const FDynamicPropertyModifierSlot& Slot = Property->ModifierSlots[SlotIndex];
+			if (const UObject* Source = Slot.Source.ResolveObjectPtr())
+			{
+				SourcePath = Source->GetPathName();
+			}
+
+			const TPair<const UDynamicProperty*, FModifierHandle> Key(Property, FModifierHandle(SlotIndex, Slot.Generation));
+			if (const float* FoundDuration = RemainingDurations.Find(Key))
+			{
+				RemainingDuration = *FoundDuration;
+			}
+		}
+		PropertyWriter << SourcePath << RemainingDuration;
+	};
+
+	// Compact properties pass no property, their modifiers have neither source nor lifetime
+	auto WriteObjectModifiers = [&PropertyWriter, &ObjectTable, &WriteModifierState](const UDynamicProperty* Property, const TArray<UModifier*>& Modifiers)
+	{
+		TArray<int32> ObjectIndices;
+		TArray<int32> SlotIndices;
+		for (int32 Index = 0; Index < Modifiers.Num(); ++Index)
+		{
+			if (Modifiers[Index])
+			{
+				ObjectIndices.Add(ObjectTable.FindOrAdd(Modifiers[Index]));
+				SlotIndices.Add(Property && Property->ModifierOrder.IsValidIndex(Index) ? Property->ModifierOrder[Index].Slot : INDEX_NONE);
+			}
+		}
+
+		PropertyWriter << ObjectIndices;
+		for (const int32 SlotIndex : SlotIndices)
+		{
+			WriteModifierState(Property, SlotIndex);
+		}
+	};
+
+	for (const TPair<FGameplayTag, UDynamicProperty*>& Pair : Container.DynamicProperties)
+	{
+		const UDynamicProperty* Property = Pair.Value;
+		int32 TagIndex = TagTable.FindOrAdd(Pair.Key.GetTagName());
+		uint8 Flags = 0;
+		float BaseValue = Property ? Property->BaseValue : 0.0f;
+		PropertyWriter << TagIndex << Flags << BaseValue;
+
+		WriteObjectModifiers(Property, Property ? Property->Modifiers : TArray<UModifier*>());
+
+		int32 NumStructModifiers = Property ? Property->StructModifiers.Num() : 0;
+		PropertyWriter << NumStructModifiers;
+		for (int32 EntryIndex = 0; EntryIndex < NumStructModifiers; ++EntryIndex)
+		{
+			const FDynamicPropertyStructModifierEntry& Entry = Property->StructModifiers[EntryIndex];
+			uint8 Kind = Entry.PooledIndex == INDEX_NONE ? StructModifier_Linear : StructModifier_Instanced;
+			int32 Priority = Entry.Key.Priority;
+			PropertyWriter << Kind << Priority;
+			WriteModifierState(Property, Entry.Key.Slot);
+
+			if (Entry.PooledIndex == INDEX_NONE)
+			{
+				FModifierLinearOp Op = Entry.Op;
+				PropertyWriter << Op.CurrentScale << Op.BaseScale << Op.Offset;
+			}
+			else
+			{
+				const FInstancedStruct& Instance = Property->StructModifierPool[Entry.PooledIndex];
+				int32 TypeIndex = TypeTable.FindOrAdd(Instance.GetScriptStruct());
+				TArray<uint8> Payload;
+				WriteStructPayload(Instance.GetScriptStruct(), Instance.GetMemory(), Payload);
+				PropertyWriter << TypeIndex << Payload;
+			}
+		}
+	}
+
+	for (int32 Index = 0; Index < Container.CompactProperties.Num(); ++Index)
+	{
+		int32 TagIndex = TagTable.FindOrAdd(Container.CompactProperties.GetTag(Index).GetTagName());
+		uint8 Flags = PropertyFlag_Compact;
+		float BaseValue = Container.CompactProperties.GetBaseValue(Index);
+		PropertyWriter << TagIndex << Flags << BaseValue;
+
+		TArray<UModifier*> Modifiers;
+		Container.CompactProperties.GetModifiers(Index, Modifiers);
+		WriteObjectModifiers(nullptr, Modifiers);
+
+		int32 NumStructModifiers = 0;
+		PropertyWriter << NumStructModifiers;
+	}
+
+	// Modifier objects, written once even if shared between properties
+	TArray<uint8> ObjectData;
+	FMemoryWriter ObjectWriter(ObjectData);
+	int32 NumObjects = ObjectTable.Values.Num();
+	ObjectWriter << NumObjects;
+	for (UModifier* Modifier : ObjectTable.Values)
+	{
+		// A copy of a shared modifier would no longer follow it, the property subscribes to it again on load
+		if (Modifier->IsA<USharedModifier>())
+		{
+			int32 TypeIndex = SharedModifierReference;
+			FString Path = Modifier->GetPathName();
+			ObjectWriter << TypeIndex << Path;
+			continue;
+		}
+
+		int32 TypeIndex = TypeTable.FindOrAdd(Modifier->GetClass());
+		TArray<uint8> Payload;
+		FMemoryWriter PayloadWriter(Payload);
+		FObjectAndNameAsStringProxyArchive PayloadArchive(PayloadWriter, false);
+		Modifier->SerializeScriptProperties(PayloadArchive);
+		ObjectWriter << TypeIndex << Payload;
+	}
+
+	// Header and tables, then the sections written above
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+
+	uint32 MagicValue = Magic;
+	uint32 VersionValue = Version;
+	Writer << MagicValue << VersionValue;
+
+	TArray<FString> TagNames;
+	for (const FName& TagName : TagTable.Values)
+	{
+		TagNames.Add(TagName.ToString());
+	}
+	Writer << TagNames;
+
+	TArray<FString> TypePaths;
+	for (const UStruct* Type : TypeTable.Values)
+	{
+		TypePaths.Add(Type->GetPathName());
+	}
+	Writer << TypePaths;
+
+	Writer.Serialize(ObjectData.GetData(), ObjectData.Num());
+	Writer.Serialize(PropertyData.GetData(), PropertyData.Num());
+}
+
+bool FDynamicPropertiesSnapshot::Load(UDynamicPropertiesContainer& Container, const TArray<uint8>& Data)
+{
+	using namespace DynamicPropertiesSnapshot;
+
+	if (Container.IsBatching())
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("FDynamicPropertiesSnapshot::Load - Cannot restore a container while it is batching."));
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 MagicValue = 0;
+	uint32 VersionValue = 0;
+	Reader << MagicValue << VersionValue;
+	if (Reader.IsError() || MagicValue != Magic || VersionValue == 0 || VersionValue > Version)
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("FDynamicPropertiesSnapshot::Load - Not a snapshot or unsupported version %u."), VersionValue);
+		return false;
+	}
+
+	// Phase 1: read and validate everything, the container is only touched once the whole snapshot is known to be valid
+	TArray<FString> TagNames;
+	TArray<FString> TypePaths;
+	Reader << TagNames << TypePaths;
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	TArray<FGameplayTag> Tags;
+	for (const FString& TagName : TagNames)
+	{
+		Tags.Add(FGameplayTag::RequestGameplayTag(FName(*TagName), false));
+	}
+
+	TArray<const UStruct*> Types;
+	for (const FString& TypePath : TypePaths)
+	{
+		const UStruct* Type = LoadObject<UStruct>(nullptr, *TypePath);
+		if (!Type)
+		{
+			UE_LOG(LogDynamicProperties, Warning, TEXT("FDynamicPropertiesSnapshot::Load - Unknown modifier type %s, its modifiers are skipped."), *TypePath);
+		}
+		Types.Add(Type);
+	}
+
+	int32 NumObjects = 0;
+	Reader << NumObjects;
+	TArray<FLoadedObject> Objects;
+	for (int32 ObjectIndex = 0; ObjectIndex < NumObjects && !Reader.IsError(); ++ObjectIndex)
+	{
+		FLoadedObject& Object = Objects.AddDefaulted_GetRef();
+
+		int32 TypeIndex = INDEX_NONE;
+		Reader << TypeIndex;
+
+		if (TypeIndex == SharedModifierReference)
+		{
+			// Shared modifiers are looked up, not loaded, they only exist while something created them
+			FString Path;
+			Reader << Path;
+			Object.SharedModifier = FindObject<USharedModifier>(nullptr, *Path);
+			if (!Object.SharedModifier && !Reader.IsError())
+			{
+				UE_LOG(LogDynamicProperties, Warning, TEXT("FDynamicPropertiesSnapshot::Load - Shared modifier %s no longer exists, it is skipped."), *Path);
+			}
+			continue;
+		}
+
+		Reader << Object.Payload;
+
+		const UClass* ModifierClass = Types.IsValidIndex(TypeIndex) ? Cast<UClass>(Types[TypeIndex]) : nullptr;
+		if (ModifierClass && ModifierClass->IsChildOf(UModifier::StaticClass()) && !ModifierClass->HasAnyClassFlags(CLASS_Abstract))
+		{
+			Object.Class = ModifierClass;
+		}
+	}
+
+	int32 NumProperties = 0;
+	Reader << NumProperties;
+	if (Reader.IsError() || NumProperties < 0)
+	{
+		return false;
+	}
+
+	// The count is untrusted, only reserve what the remaining data can hold
+	TArray<FLoadedProperty> Properties;
+	Properties.Reserve(static_cast<int32>(FMath::Min<int64>(NumProperties, (Reader.TotalSize() - Reader.Tell()) / MinPropertySize)));
+	for (int32 PropertyIndex = 0; PropertyIndex < NumProperties && !Reader.IsError(); ++PropertyIndex)
+	{
+		FLoadedProperty& Property = Properties.AddDefaulted_GetRef();
+
+		int32 TagIndex = INDEX_NONE;
+		Reader << TagIndex << Property.Flags << Property.BaseValue;
+		Property.Tag = Tags.IsValidIndex(TagIndex) ? Tags[TagIndex] : FGameplayTag();
+
+		TArray<int32> ObjectIndices;
+		Reader << ObjectIndices;
+		for (int32 Index = 0; Index < ObjectIndices.Num() && !Reader.IsError(); ++Index)
+		{
+			FLoadedModifierState State;
+			ReadModifierState(Reader, VersionValue, State);
+
+			const int32 ObjectIndex = ObjectIndices[Index];
+			if (Objects.IsValidIndex(ObjectIndex) && Objects[ObjectIndex].IsValid())
+			{
+				Property.ObjectIndices.Add(ObjectIndex);
+				Property.ObjectStates.Add(State);
+			}
+		}
+
+		int32 NumStructModifiers = 0;
+		Reader << NumStructModifiers;
+		for (int32 EntryIndex = 0; EntryIndex < NumStructModifiers && !Reader.IsError(); ++EntryIndex)
+		{
+			FLoadedStructModifier StructModifier;
+			uint8 Kind = StructModifier_Linear;
+			Reader << Kind << StructModifier.Priority;
+			ReadModifierState(Reader, VersionValue, StructModifier.State);
+
+			if (Kind == StructModifier_Linear)
+			{
+				Reader << StructModifier.Op.CurrentScale << StructModifier.Op.BaseScale << StructModifier.Op.Offset;
+			}
+			else
+			{
+				int32 TypeIndex = INDEX_NONE;
+				TArray<uint8> Payload;
+				Reader << TypeIndex << Payload;
+
+				const UScriptStruct* ModifierStruct = Types.IsValidIndex(TypeIndex) ? Cast<UScriptStruct>(Types[TypeIndex]) : nullptr;
+				if (!ModifierStruct || !ModifierStruct->IsChildOf(FDynamicPropertyModifier::StaticStruct()))
+				{
+					continue;
+				}
+
+				StructModifier.Instance.InitializeAs(ModifierStruct);
+				ReadStructPayload(ModifierStruct, StructModifier.Instance.GetMutableMemory(), Payload);
+			}
+
+			Property.StructModifiers.Add(MoveTemp(StructModifier));
+		}
+
+		// Properties whose tag no longer exists are dropped
+		if (!Property.Tag.IsValid())
+		{
+			Properties.Pop();
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("FDynamicPropertiesSnapshot::Load - Snapshot is truncated."));
+		return false;
+	}
+
+	// Phase 2: create the modifier objects, then replace the properties without going through the per-property add path
+	TArray<UModifier*> Modifiers;
+	Modifiers.Reserve(Objects.Num());
+	for (const FLoadedObject& Object : Objects)
+	{
+		UModifier* Modifier = Object.SharedModifier;
+		if (Object.Class)
+		{
+			Modifier = NewObject<UModifier>(&Container, Object.Class);
+			FMemoryReader PayloadReader(Object.Payload);
+			FObjectAndNameAsStringProxyArchive PayloadArchive(PayloadReader, true);
+			Modifier->SerializeScriptProperties(PayloadArchive);
+		}
+		Modifiers.Add(Modifier);
+	}
+
+	// Shared modifiers applied to the replaced properties stop pushing changes to them
+	TArray<UModifier*> OldModifiers;
+	for (const TPair<FGameplayTag, UDynamicProperty*>& Pair : Container.DynamicProperties)
+	{
+		if (Pair.Value)
+		{
+			for (UModifier* OldModifier : Pair.Value->Modifiers)
+			{
+				if (USharedModifier* SharedModifier = Cast<USharedModifier>(OldModifier))
+				{
+					SharedModifier->RemoveSubscriber(&Container, Pair.Key);
+				}
+			}
+			Pair.Value->SetOwningContainer(nullptr, FGameplayTag());
+		}
+	}
+	for (int32 Index = 0; Index < Container.CompactProperties.Num(); ++Index)
+	{
+		Container.CompactProperties.GetModifiers(Index, OldModifiers);
+		for (UModifier* OldModifier : OldModifiers)
+		{
+			if (USharedModifier* SharedModifier = Cast<USharedModifier>(OldModifier))
+			{
+				SharedModifier->RemoveSubscriber(&Container, Container.CompactProperties.GetTag(Index));
+			}
+		}
+	}
+	Container.DynamicProperties.Reset();
+	Container.CompactProperties.Reset();
+	Container.DirtyPropertyTags.Reset();
+
+	const bool bLazy = Container.UsesLazyEvaluation();
+	for (FLoadedProperty& Loaded : Properties)
+	{
+		if (Container.HasProperty(Loaded.Tag))
+		{
+			continue;
+		}
+
+		TArray<UModifier*> LoadedModifiers;
+		for (const int32 ObjectIndex : Loaded.ObjectIndices)
+		{
+			LoadedModifiers.Add(Modifiers[ObjectIndex]);
+			if (USharedModifier* SharedModifier = Cast<USharedModifier>(Modifiers[ObjectIndex]))
+			{
+				SharedModifier->AddSubscriber(&Container, Loaded.Tag);
+			}
+		}
+
+		// Compact storage has no room for struct modifiers
+		if ((Loaded.Flags & PropertyFlag_Compact) && Loaded.StructModifiers.Num() == 0)
+		{
+			const int32 Index = Container.CompactProperties.Add(Loaded.Tag, Loaded.BaseValue).Index;
+			for (UModifier* Modifier : LoadedModifiers)
+			{
+				Container.CompactProperties.AddModifier(Index, Modifier);
+			}
+			continue;
+		}
+
+		UDynamicProperty* Property = NewObject<UDynamicProperty>(&Container);
+		Property->BaseValue = Loaded.BaseValue;
+		Property->bLazyEvaluation = bLazy;
+
+		// Modifiers scheduled again once the property is in the container
+		TArray<TTuple<UModifier*, FModifierHandle, float>> TimedModifiers;
+
+		// Stacks were saved in application order, slots are taken in that order so the rebuild keeps each modifier's source
+		Property->Modifiers = MoveTemp(LoadedModifiers);
+		for (int32 Index = 0; Index < Property->Modifiers.Num(); ++Index)
+		{
+			const FLoadedModifierState& State = Loaded.ObjectStates[Index];
+			const int32 SlotIndex = Property->AllocateModifierSlot(Property->Modifiers[Index], State.Source);
+			if (State.RemainingDuration >= 0.0f)
+			{
+				TimedModifiers.Emplace(Property->Modifiers[Index], FModifierHandle(SlotIndex, Property->ModifierSlots[SlotIndex].Generation), State.RemainingDuration);
+			}
+		}
+
+		for (FLoadedStructModifier& StructModifier : Loaded.StructModifiers)
+		{
+			FDynamicPropertyStructModifierEntry Entry;
+			Entry.Key.Priority = StructModifier.Priority;
+			Entry.Op = StructModifier.Op;
+			const FModifierHandle Handle = Property->InsertStructModifier(Entry, StructModifier.Instance.GetScriptStruct(), StructModifier.Instance.GetMemory(), StructModifier.State.Source);
+			if (StructModifier.State.RemainingDuration >= 0.0f)
+			{
+				TimedModifiers.Emplace(nullptr, Handle, StructModifier.State.RemainingDuration);
+			}
+		}
+
+		Property->RebuildModifierOrder();
+		Property->CompileModifiers();
+
+		Container.DynamicProperties.Add(Loaded.Tag, Property);
+		Property->SetOwningContainer(&Container, Loaded.Tag);
+
+		for (const TTuple<UModifier*, FModifierHandle, float>& TimedModifier : TimedModifiers)
+		{
+			Property->ScheduleModifierExpiration(TimedModifier.Get<0>(), TimedModifier.Get<1>(), TimedModifier.Get<2>());
+		}
+	}
+
+	// Values are calculated once every property is in place, inputs before the properties reading them
+	Container.OnPropertiesRestoredInternal();
+
+	return true;
+}
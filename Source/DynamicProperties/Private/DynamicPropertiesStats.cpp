@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertiesStats.h"
+#include "DynamicPropertiesLog.h"
+
+#if DYNAMIC_PROPERTIES_STATS
+
+#include "HAL/IConsoleManager.h"
+
+DEFINE_STAT(STAT_DynamicProperties_Recalculate);
+DEFINE_STAT(STAT_DynamicProperties_Broadcast);
+DEFINE_STAT(STAT_DynamicProperties_CascadeUpdate);
+DEFINE_STAT(STAT_DynamicProperties_CascadeUpdateOrder);
+DEFINE_STAT(STAT_DynamicProperties_EndBatch);
+DEFINE_STAT(STAT_DynamicProperties_Flush);
+DEFINE_STAT(STAT_DynamicProperties_RecalculateAll);
+DEFINE_STAT(STAT_DynamicProperties_SubsystemEvaluate);
+DEFINE_STAT(STAT_DynamicProperties_ExpireModifiers);
+DEFINE_STAT(STAT_DynamicProperties_PublishReadView);
+
+DEFINE_STAT(STAT_DynamicProperties_Recalculations);
+DEFINE_STAT(STAT_DynamicProperties_Broadcasts);
+DEFINE_STAT(STAT_DynamicProperties_CascadeNodesVisited);
+DEFINE_STAT(STAT_DynamicProperties_ModifiersEvaluated);
+
+namespace DynamicPropertiesStats
+{
+	static bool bTrackHotspots = false;
+	static FAutoConsoleVariableRef CVarTrackHotspots(
+		TEXT("DynamicProperties.TrackHotspots"),
+		bTrackHotspots,
+		TEXT("Collects per-container and per-tag counters for DynamicProperties.DumpHotspots."));
+
+	/** Accumulated counters of a container or tag */
+	struct FCounts
+	{
+		uint64 Values[static_cast<int32>(EDynamicPropertiesCounter::Num)] = {};
+
+		uint64 Total() const
+		{
+			uint64 Sum = 0;
+			for (const uint64 Value : Values)
+			{
+				Sum += Value;
+			}
+			return Sum;
+		}
+	};
+
+	static TMap<TWeakObjectPtr<const UObject>, FCounts> ContainerCounts;
+	static TMap<FGameplayTag, FCounts> TagCounts;
+
+	template <typename KeyType>
+	void DumpTop(const TCHAR* Title, const TMap<KeyType, FCounts>& Counts, int32 MaxEntries, TFunctionRef<FString(const KeyType&)> Describe)
+	{
+		TArray<TPair<KeyType, FCounts>> Sorted = Counts.Array();
+		Sorted.Sort([](const TPair<KeyType, FCounts>& A, const TPair<KeyType, FCounts>& B)
+		{
+			return A.Value.Total() > B.Value.Total();
+		});
+
+		UE_LOG(LogDynamicProperties, Display, TEXT("%s (recalculations, broadcasts, cascade nodes visited, modifiers evaluated):"), Title);
+		for (int32 Index = 0; Index < FMath::Min(MaxEntries, Sorted.Num()); ++Index)
+		{
+			const uint64* Values = Sorted[Index].Value.Values;
+			UE_LOG(LogDynamicProperties, Display, TEXT("  %-60s %10llu %10llu %10llu %10llu"), *Describe(Sorted[Index].Key), Values[0], Values[1], Values[2], Values[3]);
+		}
+	}
+
+	void DumpHotspots(const TArray<FString>& Args)
+	{
+		const int32 MaxEntries = Args.Num() > 0 && Args[0].IsNumeric() ? FCString::Atoi(*Args[0]) : 10;
+
+		if (!bTrackHotspots && ContainerCounts.Num() == 0)
+		{
+			UE_LOG(LogDynamicProperties, Display, TEXT("DynamicProperties.DumpHotspots - Nothing recorded, enable DynamicProperties.TrackHotspots first."));
+			return;
+		}
+
+		DumpTop<TWeakObjectPtr<const UObject>>(TEXT("Hottest containers"), ContainerCounts, MaxEntries, [](const TWeakObjectPtr<const UObject>& Container)
+		{
+			return Container.IsValid() ? Container->GetPathName() : FString(TEXT("<destroyed>"));
+		});
+
+		DumpTop<FGameplayTag>(TEXT("Hottest tags"), TagCounts, MaxEntries, [](const FGameplayTag& PropertyTag)
+		{
+			return PropertyTag.ToString();
+		});
+
+		if (Args.Contains(TEXT("reset")))
+		{
+			ContainerCounts.Reset();
+			TagCounts.Reset();
+		}
+	}
+
+	static FAutoConsoleCommand DumpHotspotsCommand(
+		TEXT("DynamicProperties.DumpHotspots"),
+		TEXT("Prints the containers and tags with the most recalculations, broadcasts, cascade visits and modifier evaluations. Usage: DynamicProperties.DumpHotspots [Count] [reset]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&DumpHotspots));
+}
+
+void FDynamicPropertiesStats::Record(EDynamicPropertiesCounter Counter, const UObject* Container, FGameplayTag PropertyTag, uint32 Amount)
+{
+	using namespace DynamicPropertiesStats;
+
+	if (!bTrackHotspots || !IsInGameThread())
+	{
+		return;
+	}
+
+	const int32 CounterIndex = static_cast<int32>(Counter);
+	if (Container)
+	{
+		ContainerCounts.FindOrAdd(Container).Values[CounterIndex] += Amount;
+	}
+	if (PropertyTag.IsValid())
+	{
+		TagCounts.FindOrAdd(PropertyTag).Values[CounterIndex] += Amount;
+	}
+}
+
+#endif
@@ -0,0 +1,248 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertiesSubsystem.h"
+#include "DynamicPropertiesLog.h"
+#include "DynamicPropertiesContainer.h"
+#include "DynamicProperty.h"
+#include "Modifier.h"
+#include "DynamicPropertiesStats.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+namespace DynamicPropertiesSubsystem
+{
+	/** Orders ExpirationHeap so that the earliest expiration is on top */
+	struct FExpirationPredicate
+	{
+		bool operator()(const FDynamicPropertiesModifierExpiration& A, const FDynamicPropertiesModifierExpiration& B) const
+		{
+			return A.ExpirationTime < B.ExpirationTime;
+		}
+	};
+}
+
+void UDynamicPropertiesSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Expired modifiers dirty their containers, which are then evaluated in the same frame
+	ExpireModifiers();
+	EvaluateDirtyContainers();
+
+	// Last, so that listeners see every change made this frame
+	FlushCoalescedValueChanges();
+	PublishReadViews();
+}
+
+TStatId UDynamicPropertiesSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDynamicPropertiesSubsystem, STATGROUP_Tickables);
+}
+
+void UDynamicPropertiesSubsystem::RegisterDirtyContainer(UDynamicPropertiesContainer* Container)
+{
+	if (Container)
+	{
+		DirtyContainers.Add(Container);
+	}
+}
+
+void UDynamicPropertiesSubsystem::RegisterCoalescingContainer(UDynamicPropertiesContainer* Container)
+{
+	if (Container)
+	{
+		CoalescingContainers.Add(Container);
+	}
+}
+
+void UDynamicPropertiesSubsystem::FlushCoalescedValueChanges()
+{
+	// Containers changed by listeners register again and are flushed next frame
+	TArray<TWeakObjectPtr<UDynamicPropertiesContainer>> Containers = MoveTemp(CoalescingContainers);
+	CoalescingContainers.Reset();
+
+	for (const TWeakObjectPtr<UDynamicPropertiesContainer>& WeakContainer : Containers)
+	{
+		if (UDynamicPropertiesContainer* Container = WeakContainer.Get())
+		{
+			Container->FlushCoalescedValueChanges();
+		}
+	}
+}
+
+void UDynamicPropertiesSubsystem::RegisterPublishingContainer(UDynamicPropertiesContainer* Container)
+{
+	if (Container)
+	{
+		PublishingContainers.Add(Container);
+	}
+}
+
+void UDynamicPropertiesSubsystem::PublishReadViews()
+{
+	TArray<TWeakObjectPtr<UDynamicPropertiesContainer>> Containers = MoveTemp(PublishingContainers);
+	PublishingContainers.Reset();
+
+	for (const TWeakObjectPtr<UDynamicPropertiesContainer>& WeakContainer : Containers)
+	{
+		if (UDynamicPropertiesContainer* Container = WeakContainer.Get())
+		{
+			Container->PublishReadView();
+		}
+	}
+}
+
+void UDynamicPropertiesSubsystem::EvaluateDirtyContainers()
+{
+	if (DirtyContainers.Num() == 0)
+	{
+		return;
+	}
+
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_SubsystemEvaluate);
+
+	// Containers dirtied while committing are evaluated next frame
+	TArray<UDynamicPropertiesContainer*> Containers;
+	Containers.Reserve(DirtyContainers.Num());
+	for (const TWeakObjectPtr<UDynamicPropertiesContainer>& WeakContainer : DirtyContainers)
+	{
+		if (UDynamicPropertiesContainer* Container = WeakContainer.Get())
+		{
+			Container->bRegisteredWithSubsystem = false;
+			Containers.Add(Container);
+		}
+	}
+	DirtyContainers.Reset();
+
+	FDynamicPropertiesEvaluationStats Stats;
+	Stats.NumContainers = Containers.Num();
+
+	// Phase 1: evaluate native modifier stacks in parallel, each container is only touched by one task
+	const double ParallelStartTime = FPlatformTime::Seconds();
+	TArray<int32> PrecomputedCounts;
+	PrecomputedCounts.SetNumZeroed(Containers.Num());
+	ParallelFor(Containers.Num(), [&Containers, &PrecomputedCounts](int32 Index)
+	{
+		PrecomputedCounts[Index] = Containers[Index]->PrecomputePendingValues();
+	});
+	const double CommitStartTime = FPlatformTime::Seconds();
+
+	// Phase 2: apply values, run Blueprint modifiers and broadcast events on the game thread
+	for (UDynamicPropertiesContainer* Container : Containers)
+	{
+		Container->FlushPendingChanges();
+	}
+	const double EndTime = FPlatformTime::Seconds();
+
+	for (int32 Count : PrecomputedCounts)
+	{
+		Stats.NumPrecomputedProperties += Count;
+	}
+	Stats.ParallelEvaluationSeconds = static_cast<float>(CommitStartTime - ParallelStartTime);
+	Stats.GameThreadCommitSeconds = static_cast<float>(EndTime - CommitStartTime);
+	LastEvaluationStats = Stats;
+
+	UE_LOG(LogDynamicProperties, Verbose, TEXT("UDynamicPropertiesSubsystem::EvaluateDirtyContainers - %d containers, %d precomputed properties, parallel %.3f ms, game thread %.3f ms"),
+		Stats.NumContainers, Stats.NumPrecomputedProperties, Stats.ParallelEvaluationSeconds * 1000.0f, Stats.GameThreadCommitSeconds * 1000.0f);
+}
+
+void UDynamicPropertiesSubsystem::ScheduleModifierExpiration(const FDynamicPropertiesModifierExpiration& Expiration, float Duration)
+{
+	FDynamicPropertiesModifierExpiration Scheduled = Expiration;
+	Scheduled.ExpirationTime = GetWorld()->GetTimeSeconds() + FMath::Max(Duration, 0.0f);
+	ExpirationHeap.HeapPush(MoveTemp(Scheduled), DynamicPropertiesSubsystem::FExpirationPredicate());
+}
+
+void UDynamicPropertiesSubsystem::GetRemainingModifierDurations(const UDynamicPropertiesContainer* Container, TMap<TPair<const UDynamicProperty*, FModifierHandle>, float>& OutRemainingDurations) const
+{
+	OutRemainingDurations.Reset();
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (const FDynamicPropertiesModifierExpiration& Expiration : ExpirationHeap)
+	{
+		// Removals of modifiers that are already gone are skipped
+		const UDynamicProperty* Property = Expiration.Property.Get();
+		if (Expiration.Container.Get() == Container && Property && Property->IsModifierHandleValid(Expiration.Handle))
+		{
+			OutRemainingDurations.Add(TPair<const UDynamicProperty*, FModifierHandle>(Property, Expiration.Handle), static_cast<float>(FMath::Max(Expiration.ExpirationTime - Now, 0.0)));
+		}
+	}
+}
+
+void UDynamicPropertiesSubsystem::ExpireModifiers()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (ExpirationHeap.Num() == 0 || ExpirationHeap.HeapTop().ExpirationTime > Now)
+	{
+		return;
+	}
+
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_ExpireModifiers);
+
+	TArray<FDynamicPropertiesModifierExpiration> Expired;
+	while (ExpirationHeap.Num() > 0 && ExpirationHeap.HeapTop().ExpirationTime <= Now)
+	{
+		FDynamicPropertiesModifierExpiration& Expiration = Expired.AddDefaulted_GetRef();
+		ExpirationHeap.HeapPop(Expiration, DynamicPropertiesSubsystem::FExpirationPredicate(), false);
+	}
+
+	// Every removal happens inside a batch, so each affected property is recalculated once
+	TArray<UDynamicPropertiesContainer*, TInlineAllocator<16>> BatchedContainers;
+	TArray<UDynamicProperty*, TInlineAllocator<16>> BatchedProperties;
+	for (const FDynamicPropertiesModifierExpiration& Expiration : Expired)
+	{
+		if (UDynamicPropertiesContainer* Container = Expiration.Container.Get())
+		{
+			if (!BatchedContainers.Contains(Container))
+			{
+				BatchedContainers.Add(Container);
+				Container->BeginBatch();
+			}
+		}
+		else if (UDynamicProperty* Property = Expiration.Property.Get())
+		{
+			if (!BatchedProperties.Contains(Property))
+			{
+				BatchedProperties.Add(Property);
+				Property->BeginBatch();
+			}
+		}
+	}
+
+	for (const FDynamicPropertiesModifierExpiration& Expiration : Expired)
+	{
+		UDynamicPropertiesContainer* Container = Expiration.Container.Get();
+		UDynamicProperty* Property = Expiration.Property.Get();
+
+		if (Expiration.Handle.IsValid())
+		{
+			// A stale handle or a destroyed property means the modifier was removed already
+			if (Property)
+			{
+				Property->RemoveModifierByHandle(Expiration.Handle);
+			}
+		}
+		else if (UModifier* Modifier = Expiration.Modifier.Get())
+		{
+			// Going through the container also covers properties that moved between compact storage and objects
+			if (Container)
+			{
+				Container->RemovePropertyModifier(Expiration.PropertyTag, Modifier);
+			}
+			else if (Property)
+			{
+				Property->RemoveModifier(Modifier);
+			}
+		}
+	}
+
+	for (UDynamicProperty* Property : BatchedProperties)
+	{
+		Property->EndBatch();
+	}
+
+	for (UDynamicPropertiesContainer* Container : BatchedContainers)
+	{
+		Container->EndBatch();
+	}
+}
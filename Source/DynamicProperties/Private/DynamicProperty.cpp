@@ -1,6 +1,13 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "DynamicProperty.h"
+#include "DynamicPropertiesLog.h"
+#include "DynamicPropertiesContainer.h"
+#include "DynamicPropertiesSubsystem.h"
+#include "DynamicPropertiesStats.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+#include "Engine/World.h"
 
 UDynamicProperty::UDynamicProperty()
 {
@@ -8,68 +15,869 @@ UDynamicProperty::UDynamicProperty()
 	Value = 0.0f;
 }
 
+void UDynamicProperty::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	if (Ar.IsCountingMemory())
+	{
+		const SIZE_T NativeSize = GetAllocatedSize();
+		Ar.CountBytes(NativeSize, NativeSize);
+	}
+}
+
+SIZE_T UDynamicProperty::GetAllocatedSize() const
+{
+	SIZE_T Size = StructModifiers.GetAllocatedSize()
+		+ FreeStructModifierSlots.GetAllocatedSize()
+		+ ModifierSlots.GetAllocatedSize()
+		+ FreeModifierSlots.GetAllocatedSize()
+		+ ModifierSlotsBySource.GetAllocatedSize()
+		+ ModifierOrder.GetAllocatedSize()
+		+ ModifierProgram.GetAllocatedSize();
+
+	for (const TPair<FObjectKey, TArray<int32, TInlineAllocator<4>>>& Pair : ModifierSlotsBySource)
+	{
+		Size += Pair.Value.GetAllocatedSize();
+	}
+
+	// Pooled struct modifiers own their struct memory outside of the reflected array
+	for (const FInstancedStruct& PooledModifier : StructModifierPool)
+	{
+		if (const UScriptStruct* ScriptStruct = PooledModifier.GetScriptStruct())
+		{
+			Size += ScriptStruct->GetStructureSize();
+		}
+	}
+
+	return Size;
+}
+
+template <typename ObjectVisitorType, typename StructVisitorType>
+bool UDynamicProperty::VisitModifiersInOrder(ObjectVisitorType&& VisitObject, StructVisitorType&& VisitStruct) const
+{
+	int32 StructIndex = 0;
+	for (UModifier* Modifier : Modifiers)
+	{
+		if (!Modifier)
+		{
+			continue;
+		}
+
+		while (StructIndex < StructModifiers.Num() && StructModifiers[StructIndex].Key.Priority < Modifier->Priority)
+		{
+			if (!VisitStruct(StructModifiers[StructIndex++]))
+			{
+				return false;
+			}
+		}
+
+		if (!VisitObject(Modifier))
+		{
+			return false;
+		}
+	}
+
+	for (; StructIndex < StructModifiers.Num(); ++StructIndex)
+	{
+		if (!VisitStruct(StructModifiers[StructIndex]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 float UDynamicProperty::CalculateForBaseValue(float InBaseValue)
 {
 	float CalculatedValue = InBaseValue;
 
-	// Apply all modifiers sequentially
-	for (UModifier* Modifier : Modifiers)
+	// Fast path: built-in modifiers only, evaluated without the Apply event
+	if (bModifierProgramValid)
 	{
-		if (Modifier)
+		for (const FModifierLinearOp& Op : ModifierProgram)
 		{
-			CalculatedValue = Modifier->Apply(InBaseValue, CalculatedValue);
+			CalculatedValue = Op.Apply(InBaseValue, CalculatedValue);
 		}
+
+		return CalculatedValue;
 	}
 
+	// Apply all modifiers sequentially
+	VisitModifiersInOrder(
+		[this, &CalculatedValue, InBaseValue](UModifier* Modifier)
+		{
+			CalculatedValue = Modifier->ApplyInContainer(InBaseValue, CalculatedValue, OwningContainer);
+			return true;
+		},
+		[this, &CalculatedValue, InBaseValue](const FDynamicPropertyStructModifierEntry& Entry)
+		{
+			CalculatedValue = ApplyStructModifier(Entry, InBaseValue, CalculatedValue);
+			return true;
+		});
+
 	return CalculatedValue;
 }
 
 void UDynamicProperty::Recalculate()
 {
+	DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_Recalculate);
+	DYNAMIC_PROPERTIES_COUNT(Recalculations, OwningContainer, PropertyTag, 1);
+
+	bValueDirty = false;
+
 	float OldValue = Value;
-	Value = CalculateForBaseValue(BaseValue);
+
+	// Reuse a value precomputed off the game thread if it was computed for the same inputs
+	if (bHasPrecomputedValue && bModifierProgramValid && PrecomputedBaseValue == BaseValue)
+	{
+		Value = PrecomputedValue;
+	}
+	else
+	{
+		Value = CalculateForBaseValue(BaseValue);
+		DYNAMIC_PROPERTIES_COUNT(ModifiersEvaluated, OwningContainer, PropertyTag, Modifiers.Num() + StructModifiers.Num());
+	}
+	bHasPrecomputedValue = false;
 
 	// Fire event if value changed
 	if (!FMath::IsNearlyEqual(OldValue, Value))
 	{
-		ValueChanged.Broadcast(OldValue, Value);
+		NotifyValueChanged(OldValue, Value);
 	}
 }
 
-void UDynamicProperty::AddModifier(UModifier* Modifier)
+FModifierHandle UDynamicProperty::AddModifier(UModifier* Modifier, UObject* Source)
 {
-	if (Modifier)
+	if (!Modifier)
 	{
-		Modifiers.Add(Modifier);
-		SortModifiers();
-		Recalculate();
+		return FModifierHandle();
 	}
+
+	EnsureModifierOrder();
+
+	// Binary insertion after every modifier with the same or lower priority, no sort needed
+	const int32 SlotIndex = AllocateModifierSlot(Modifier, Source);
+	const FDynamicPropertyModifierOrderKey Key{ Modifier->Priority, NextModifierSequence++, SlotIndex };
+	const int32 InsertIndex = Algo::UpperBound(ModifierOrder, Key);
+	Modifiers.Insert(Modifier, InsertIndex);
+	ModifierOrder.Insert(Key, InsertIndex);
+	ModifierSlots[SlotIndex].Key = Key;
+
+	OnModifiersChanged(false);
+
+	return FModifierHandle(SlotIndex, ModifierSlots[SlotIndex].Generation);
 }
 
 void UDynamicProperty::RemoveModifier(UModifier* Modifier)
 {
 	if (Modifier)
 	{
-		Modifiers.Remove(Modifier);
-		Recalculate();
+		EnsureModifierOrder();
+
+		int32 NumRemoved = 0;
+		auto RemoveInRange = [this, Modifier, &NumRemoved](int32 Begin, int32 End)
+		{
+			for (int32 Index = End - 1; Index >= Begin; --Index)
+			{
+				if (Modifiers[Index] == Modifier)
+				{
+					FreeModifierSlot(ModifierOrder[Index].Slot);
+					Modifiers.RemoveAt(Index);
+					ModifierOrder.RemoveAt(Index);
+					++NumRemoved;
+				}
+			}
+		};
+
+		// Look among modifiers of the same priority first, then everywhere in case the priority was edited since
+		RemoveInRange(
+			Algo::LowerBoundBy(ModifierOrder, Modifier->Priority, &FDynamicPropertyModifierOrderKey::Priority),
+			Algo::UpperBoundBy(ModifierOrder, Modifier->Priority, &FDynamicPropertyModifierOrderKey::Priority));
+		if (NumRemoved == 0)
+		{
+			RemoveInRange(0, Modifiers.Num());
+		}
+
+		if (NumRemoved == 0)
+		{
+			return;
+		}
+
+		OnModifiersChanged(false);
 	}
 }
 
+void UDynamicProperty::RefreshModifiers()
+{
+	OnModifiersChanged(true);
+}
+
+FModifierHandle UDynamicProperty::AddStructModifier(const FInstancedStruct& Modifier, UObject* Source)
+{
+	return AddStructModifierOfType(Modifier.GetScriptStruct(), Modifier.GetMemory(), Source);
+}
+
+FModifierHandle UDynamicProperty::AddStructModifierOfType(const UScriptStruct* ModifierType, const void* ModifierMemory, const UObject* Source)
+{
+	if (!ModifierType || !ModifierMemory || !ModifierType->IsChildOf(FDynamicPropertyModifier::StaticStruct()))
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("UDynamicProperty::AddStructModifier - Struct is not a FDynamicPropertyModifier. Ignoring."));
+		return FModifierHandle();
+	}
+
+	const FDynamicPropertyModifier& Modifier = *static_cast<const FDynamicPropertyModifier*>(ModifierMemory);
+
+	FDynamicPropertyStructModifierEntry Entry;
+	Entry.Key.Priority = Modifier.Priority;
+
+	// Linear modifiers live entirely in the entry, only the others need a copy of the struct
+	const bool bLinear = Modifier.GetLinearOp(Entry.Op);
+	const FModifierHandle Handle = InsertStructModifier(Entry, bLinear ? nullptr : ModifierType, ModifierMemory, Source);
+
+	OnModifiersChanged(false);
+
+	return Handle;
+}
+
+bool UDynamicProperty::UpdateStructModifier(FModifierHandle Handle, const FInstancedStruct& Modifier)
+{
+	const FDynamicPropertyModifierSlot* Slot = FindModifierSlot(Handle);
+	if (!Slot || !Slot->bStruct)
+	{
+		return false;
+	}
+
+	const UScriptStruct* ModifierType = Modifier.GetScriptStruct();
+	if (!ModifierType || !ModifierType->IsChildOf(FDynamicPropertyModifier::StaticStruct()))
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("UDynamicProperty::UpdateStructModifier - Struct is not a FDynamicPropertyModifier. Ignoring."));
+		return false;
+	}
+
+	const int32 EntryIndex = FindModifierPosition(Handle.GetIndex());
+	if (EntryIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FDynamicPropertyModifier& NewModifier = Modifier.Get<FDynamicPropertyModifier>();
+	FDynamicPropertyStructModifierEntry Entry = StructModifiers[EntryIndex];
+	ReleaseStructModifierPoolSlot(Entry);
+
+	Entry.Op = FModifierLinearOp();
+	Entry.PooledIndex = NewModifier.GetLinearOp(Entry.Op) ? INDEX_NONE : AllocateStructModifierSlot(ModifierType, Modifier.GetMemory());
+
+	if (Entry.Key.Priority == NewModifier.Priority)
+	{
+		StructModifiers[EntryIndex] = Entry;
+	}
+	else
+	{
+		// A new priority moves the modifier after the others of that priority, like a new one
+		StructModifiers.RemoveAt(EntryIndex);
+		Entry.Key.Priority = NewModifier.Priority;
+		Entry.Key.Sequence = NextStructModifierSequence++;
+		StructModifiers.Insert(Entry, Algo::UpperBoundBy(StructModifiers, Entry.Key, &FDynamicPropertyStructModifierEntry::Key));
+		ModifierSlots[Handle.GetIndex()].Key = Entry.Key;
+	}
+
+	OnModifiersChanged(false);
+
+	return true;
+}
+
+bool UDynamicProperty::UpdateModifier(FModifierHandle Handle)
+{
+	const FDynamicPropertyModifierSlot* Slot = FindModifierSlot(Handle);
+	if (!Slot || Slot->bStruct)
+	{
+		return false;
+	}
+
+	EnsureModifierOrder();
+
+	const int32 Index = FindModifierPosition(Handle.GetIndex());
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	UModifier* Modifier = Modifiers[Index];
+	if (Modifier && ModifierOrder[Index].Priority != Modifier->Priority)
+	{
+		Modifiers.RemoveAt(Index);
+		ModifierOrder.RemoveAt(Index);
+
+		const FDynamicPropertyModifierOrderKey Key{ Modifier->Priority, NextModifierSequence++, Handle.GetIndex() };
+		const int32 InsertIndex = Algo::UpperBound(ModifierOrder, Key);
+		Modifiers.Insert(Modifier, InsertIndex);
+		ModifierOrder.Insert(Key, InsertIndex);
+		ModifierSlots[Handle.GetIndex()].Key = Key;
+	}
+
+	// The parameters may have changed too, so the program is compiled again either way
+	OnModifiersChanged(false);
+
+	return true;
+}
+
+bool UDynamicProperty::RemoveModifierByHandle(FModifierHandle Handle)
+{
+	if (!FindModifierSlot(Handle) || !RemoveModifierInSlot(Handle.GetIndex()))
+	{
+		return false;
+	}
+
+	OnModifiersChanged(false);
+
+	return true;
+}
+
+int32 UDynamicProperty::RemoveModifiersBySource(const UObject* Source)
+{
+	const TArray<int32, TInlineAllocator<4>>* SourceSlots = ModifierSlotsBySource.Find(FObjectKey(Source));
+	if (!Source || !SourceSlots)
+	{
+		return 0;
+	}
+
+	// Removing frees the slots, which edits the source's list, so work on a copy
+	const TArray<int32, TInlineAllocator<4>> SlotsToRemove = *SourceSlots;
+
+	int32 NumRemoved = 0;
+	for (int32 SlotIndex : SlotsToRemove)
+	{
+		NumRemoved += RemoveModifierInSlot(SlotIndex) ? 1 : 0;
+	}
+
+	if (NumRemoved > 0)
+	{
+		OnModifiersChanged(false);
+	}
+
+	return NumRemoved;
+}
+
+UModifier* UDynamicProperty::GetModifierByHandle(FModifierHandle Handle) const
+{
+	const FDynamicPropertyModifierSlot* Slot = FindModifierSlot(Handle);
+	if (!Slot || Slot->bStruct || ModifierOrder.Num() != Modifiers.Num())
+	{
+		return nullptr;
+	}
+
+	// Read from the modifiers array, which keeps the object referenced
+	const int32 Index = FindModifierPosition(Handle.GetIndex());
+	return Index != INDEX_NONE ? Modifiers[Index] : nullptr;
+}
+
+FModifierHandle UDynamicProperty::AddTimedModifier(UModifier* Modifier, float Duration, UObject* Source)
+{
+	const FModifierHandle Handle = AddModifier(Modifier, Source);
+	if (Handle.IsValid())
+	{
+		ScheduleModifierExpiration(Modifier, Handle, Duration);
+	}
+	return Handle;
+}
+
+FModifierHandle UDynamicProperty::AddTimedStructModifier(const FInstancedStruct& Modifier, float Duration, UObject* Source)
+{
+	const FModifierHandle Handle = AddStructModifier(Modifier, Source);
+	if (Handle.IsValid())
+	{
+		ScheduleModifierExpiration(nullptr, Handle, Duration);
+	}
+	return Handle;
+}
+
+bool UDynamicProperty::ScheduleModifierExpiration(UModifier* Modifier, FModifierHandle Handle, float Duration)
+{
+	UWorld* World = GetWorld();
+	UDynamicPropertiesSubsystem* Subsystem = World ? World->GetSubsystem<UDynamicPropertiesSubsystem>() : nullptr;
+	if (!Subsystem)
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("UDynamicProperty::ScheduleModifierExpiration - Property is not in a world, the modifier will not expire."));
+		return false;
+	}
+
+	FDynamicPropertiesModifierExpiration Expiration;
+	Expiration.Container = OwningContainer;
+	Expiration.PropertyTag = PropertyTag;
+	Expiration.Property = this;
+	Expiration.Modifier = Modifier;
+	Expiration.Handle = Handle;
+	Subsystem->ScheduleModifierExpiration(Expiration, Duration);
+
+	return true;
+}
+
+void UDynamicProperty::OnModifiersChanged(bool bReorder)
+{
+	bModifierProgramValid = false;
+
+	if (OwningContainer)
+	{
+		OwningContainer->HandlePropertyModifiersChanged(PropertyTag);
+	}
+
+	if (IsBatching())
+	{
+		bModifiersDirty = true;
+		bModifierOrderDirty |= bReorder;
+		bValueDirty = true;
+		return;
+	}
+
+	if (bReorder)
+	{
+		RebuildModifierOrder();
+	}
+	CompileModifiers();
+	ApplyValueChange();
+}
+
 void UDynamicProperty::SetBaseValue(float NewBaseValue)
 {
 	if (!FMath::IsNearlyEqual(BaseValue, NewBaseValue))
 	{
 		BaseValue = NewBaseValue;
+		ApplyValueChange();
+	}
+}
+
+void UDynamicProperty::BeginBatch()
+{
+	++BatchDepth;
+}
+
+void UDynamicProperty::EndBatch()
+{
+	if (BatchDepth <= 0)
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("UDynamicProperty::EndBatch - Called without matching BeginBatch. Ignoring."));
+		return;
+	}
+
+	if (--BatchDepth > 0)
+	{
+		return;
+	}
+
+	if (bModifierOrderDirty)
+	{
+		bModifierOrderDirty = false;
+		RebuildModifierOrder();
+	}
+
+	if (bModifiersDirty)
+	{
+		bModifiersDirty = false;
+		CompileModifiers();
+	}
+
+	if (bValueDirty)
+	{
+		bValueDirty = false;
+		ApplyValueChange();
+	}
+}
+
+void UDynamicProperty::SetLazyEvaluation(bool bInLazyEvaluation)
+{
+	bLazyEvaluation = bInLazyEvaluation;
+
+	// Leaving lazy mode applies whatever is pending
+	if (!bLazyEvaluation)
+	{
+		FlushPendingChanges();
+	}
+}
+
+void UDynamicProperty::FlushPendingChanges()
+{
+	if (!bValueDirty || IsBatching())
+	{
+		return;
+	}
+
+	// Values this property is derived from (e.g. a cascade parent) are brought up to date first, which may change the base value
+	if (OwningContainer)
+	{
+		OwningContainer->FlushPropertyDependencies(PropertyTag);
+	}
+
+	Recalculate();
+}
+
+bool UDynamicProperty::PrecomputeValue(float InBaseValue, float& OutValue)
+{
+	if (!bModifierProgramValid)
+	{
+		return false;
+	}
+
+	OutValue = CalculateForBaseValue(InBaseValue);
+	PrecomputedBaseValue = InBaseValue;
+	PrecomputedValue = OutValue;
+	bHasPrecomputedValue = true;
+
+	return true;
+}
+
+float UDynamicProperty::GetValueSlow() const
+{
+	const_cast<UDynamicProperty*>(this)->FlushPendingChanges();
+	return Value;
+}
+
+void UDynamicProperty::ApplyValueChange()
+{
+	if (IsBatching())
+	{
+		bValueDirty = true;
+	}
+	else if (bLazyEvaluation)
+	{
+		MarkValueDirty();
+	}
+	else
+	{
 		Recalculate();
 	}
 }
 
-void UDynamicProperty::SortModifiers()
+void UDynamicProperty::MarkValueDirty()
 {
-	// Sort modifiers by priority (ascending order - lower priority values are applied first)
-	Modifiers.Sort([](const UModifier& A, const UModifier& B)
+	if (bValueDirty)
+	{
+		return;
+	}
+
+	bValueDirty = true;
+	if (OwningContainer)
 	{
-		return A.Priority < B.Priority;
-	});
+		OwningContainer->HandlePropertyDirty(PropertyTag);
+	}
+}
+
+void UDynamicProperty::SetOwningContainer(UDynamicPropertiesContainer* InContainer, FGameplayTag InPropertyTag)
+{
+	OwningContainer = InContainer;
+	PropertyTag = InContainer ? InPropertyTag : FGameplayTag();
+}
+
+void UDynamicProperty::NotifyValueChanged(float OldValue, float NewValue)
+{
+	// The container is called directly, before any Blueprint listener
+	if (OwningContainer)
+	{
+		OwningContainer->HandlePropertyValueChanged(PropertyTag, OldValue, NewValue);
+	}
+
+	BroadcastValueChanged(OldValue, NewValue);
+}
+
+void UDynamicProperty::BroadcastValueChanged(float OldValue, float NewValue)
+{
+	if (ValueChanged.IsBound())
+	{
+		DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(STAT_DynamicProperties_Broadcast);
+		DYNAMIC_PROPERTIES_COUNT(Broadcasts, OwningContainer, PropertyTag, 1);
+		ValueChanged.Broadcast(OldValue, NewValue);
+	}
+}
+
+bool UDynamicProperty::SetBaseValueSilently(float NewBaseValue, float& OutOldValue)
+{
+	if (FMath::IsNearlyEqual(BaseValue, NewBaseValue))
+	{
+		return false;
+	}
+
+	BaseValue = NewBaseValue;
+
+	if (IsBatching() || bLazyEvaluation)
+	{
+		ApplyValueChange();
+		return false;
+	}
+
+	OutOldValue = Value;
+	bValueDirty = false;
+	Value = CalculateForBaseValue(BaseValue);
+
+	return !FMath::IsNearlyEqual(OutOldValue, Value);
+}
+
+void UDynamicProperty::RebuildModifierOrder()
+{
+	Modifiers.Remove(nullptr);
+
+	// Modifiers already in a slot keep it, so their handles stay valid
+	TMap<UModifier*, TArray<int32, TInlineAllocator<1>>> SlotsByModifier;
+	for (int32 SlotIndex = 0; SlotIndex < ModifierSlots.Num(); ++SlotIndex)
+	{
+		const FDynamicPropertyModifierSlot& Slot = ModifierSlots[SlotIndex];
+		if (Slot.bInUse && !Slot.bStruct)
+		{
+			SlotsByModifier.FindOrAdd(Slot.Modifier).Add(SlotIndex);
+		}
+	}
+
+	TArray<TPair<UModifier*, int32>> SlottedModifiers;
+	SlottedModifiers.Reserve(Modifiers.Num());
+	for (UModifier* Modifier : Modifiers)
+	{
+		TArray<int32, TInlineAllocator<1>>* Slots = SlotsByModifier.Find(Modifier);
+		if (Slots && Slots->Num() > 0)
+		{
+			SlottedModifiers.Emplace(Modifier, (*Slots)[0]);
+			Slots->RemoveAt(0);
+		}
+		else
+		{
+			SlottedModifiers.Emplace(Modifier, AllocateModifierSlot(Modifier, nullptr));
+		}
+	}
+
+	// Whatever is left was taken out of the array directly
+	for (const TPair<UModifier*, TArray<int32, TInlineAllocator<1>>>& Pair : SlotsByModifier)
+	{
+		for (int32 SlotIndex : Pair.Value)
+		{
+			FreeModifierSlot(SlotIndex);
+		}
+	}
+
+	// Sort modifiers by priority (ascending order - lower priority values are applied first), keeping the current order for equal priorities
+	Algo::StableSortBy(SlottedModifiers, [](const TPair<UModifier*, int32>& SlottedModifier) { return SlottedModifier.Key->Priority; });
+
+	Modifiers.Reset(SlottedModifiers.Num());
+	ModifierOrder.Reset(SlottedModifiers.Num());
+	NextModifierSequence = 0;
+	for (const TPair<UModifier*, int32>& SlottedModifier : SlottedModifiers)
+	{
+		const FDynamicPropertyModifierOrderKey Key{ SlottedModifier.Key->Priority, NextModifierSequence++, SlottedModifier.Value };
+		Modifiers.Add(SlottedModifier.Key);
+		ModifierOrder.Add(Key);
+		ModifierSlots[SlottedModifier.Value].Key = Key;
+	}
 }
 
+void UDynamicProperty::CompileModifiers()
+{
+	ModifierProgram.Reset(Modifiers.Num() + StructModifiers.Num());
+	bModifierProgramValid = false;
+	bHasPrecomputedValue = false;
+
+	// Blueprint or custom modifiers keep the generic path for the whole stack
+	const bool bAllLinear = VisitModifiersInOrder(
+		[this](UModifier* Modifier)
+		{
+			FModifierLinearOp Op;
+			if (!Modifier->GetLinearOp(Op))
+			{
+				return false;
+			}
+
+			ModifierProgram.Add(Op);
+			return true;
+		},
+		[this](const FDynamicPropertyStructModifierEntry& Entry)
+		{
+			if (Entry.PooledIndex != INDEX_NONE)
+			{
+				return false;
+			}
+
+			ModifierProgram.Add(Entry.Op);
+			return true;
+		});
+
+	if (!bAllLinear)
+	{
+		ModifierProgram.Reset();
+		return;
+	}
+
+	bModifierProgramValid = true;
+}
+
+float UDynamicProperty::ApplyStructModifier(const FDynamicPropertyStructModifierEntry& Entry, float InBaseValue, float CurrentValue) const
+{
+	if (Entry.PooledIndex == INDEX_NONE)
+	{
+		return Entry.Op.Apply(InBaseValue, CurrentValue);
+	}
+
+	return StructModifierPool[Entry.PooledIndex].Get<FDynamicPropertyModifier>().Apply(InBaseValue, CurrentValue);
+}
+
+int32 UDynamicProperty::AllocateStructModifierSlot(const UScriptStruct* ModifierType, const void* ModifierMemory)
+{
+	int32 Slot = INDEX_NONE;
+	if (FreeStructModifierSlots.Num() > 0)
+	{
+		// Prefer a free slot that already holds the same type, its memory is reused as is
+		int32 FreeIndex = FreeStructModifierSlots.IndexOfByPredicate([this, ModifierType](int32 FreeSlot)
+		{
+			return StructModifierPool[FreeSlot].GetScriptStruct() == ModifierType;
+		});
+
+		if (FreeIndex == INDEX_NONE)
+		{
+			FreeIndex = FreeStructModifierSlots.Num() - 1;
+		}
+
+		Slot = FreeStructModifierSlots[FreeIndex];
+		FreeStructModifierSlots.RemoveAtSwap(FreeIndex);
+	}
+	else
+	{
+		Slot = StructModifierPool.AddDefaulted();
+	}
+
+	FInstancedStruct& Pooled = StructModifierPool[Slot];
+	if (Pooled.GetScriptStruct() == ModifierType)
+	{
+		ModifierType->CopyScriptStruct(Pooled.GetMutableMemory(), ModifierMemory);
+	}
+	else
+	{
+		Pooled.InitializeAs(ModifierType, static_cast<const uint8*>(ModifierMemory));
+	}
+
+	return Slot;
+}
+
+FModifierHandle UDynamicProperty::InsertStructModifier(FDynamicPropertyStructModifierEntry Entry, const UScriptStruct* ModifierType, const void* ModifierMemory, const UObject* Source)
+{
+	if (ModifierType)
+	{
+		Entry.PooledIndex = AllocateStructModifierSlot(ModifierType, ModifierMemory);
+	}
+
+	// Insert after every entry with the same or lower priority
+	const int32 SlotIndex = AllocateModifierSlot(nullptr, Source);
+	Entry.Key.Sequence = NextStructModifierSequence++;
+	Entry.Key.Slot = SlotIndex;
+	StructModifiers.Insert(Entry, Algo::UpperBoundBy(StructModifiers, Entry.Key, &FDynamicPropertyStructModifierEntry::Key));
+	ModifierSlots[SlotIndex].Key = Entry.Key;
+
+	return FModifierHandle(SlotIndex, ModifierSlots[SlotIndex].Generation);
+}
+
+void UDynamicProperty::ReleaseStructModifierPoolSlot(const FDynamicPropertyStructModifierEntry& Entry)
+{
+	// The pooled struct is reset but keeps its memory for the next modifier of the same type
+	if (Entry.PooledIndex != INDEX_NONE)
+	{
+		FInstancedStruct& Pooled = StructModifierPool[Entry.PooledIndex];
+		Pooled.GetScriptStruct()->ClearScriptStruct(Pooled.GetMutableMemory());
+		FreeStructModifierSlots.Add(Entry.PooledIndex);
+	}
+}
+
+int32 UDynamicProperty::AllocateModifierSlot(UModifier* Modifier, const UObject* Source)
+{
+	const int32 SlotIndex = FreeModifierSlots.Num() > 0 ? FreeModifierSlots.Pop() : ModifierSlots.AddDefaulted();
+
+	FDynamicPropertyModifierSlot& Slot = ModifierSlots[SlotIndex];
+	Slot.Modifier = Modifier;
+	Slot.bStruct = Modifier == nullptr;
+	Slot.bInUse = true;
+	Slot.Source = FObjectKey(Source);
+
+	if (Source)
+	{
+		ModifierSlotsBySource.FindOrAdd(Slot.Source).Add(SlotIndex);
+	}
+
+	return SlotIndex;
+}
+
+void UDynamicProperty::FreeModifierSlot(int32 SlotIndex)
+{
+	FDynamicPropertyModifierSlot& Slot = ModifierSlots[SlotIndex];
+	if (!Slot.bInUse)
+	{
+		return;
+	}
+
+	// Every way of taking a modifier object off the property ends here, expiring and removing by source included
+	if (OwningContainer && Slot.Modifier)
+	{
+		OwningContainer->HandlePropertyModifierRemoved(PropertyTag, Slot.Modifier);
+	}
+
+	if (Slot.Source != FObjectKey())
+	{
+		if (TArray<int32, TInlineAllocator<4>>* SourceSlots = ModifierSlotsBySource.Find(Slot.Source))
+		{
+			SourceSlots->RemoveSingleSwap(SlotIndex);
+			if (SourceSlots->Num() == 0)
+			{
+				ModifierSlotsBySource.Remove(Slot.Source);
+			}
+		}
+	}
+
+	// Generation 0 is never used, so default constructed handles can't match a slot
+	Slot.Generation = Slot.Generation == MAX_uint32 ? 1 : Slot.Generation + 1;
+	Slot.Modifier = nullptr;
+	Slot.Source = FObjectKey();
+	Slot.bInUse = false;
+	FreeModifierSlots.Add(SlotIndex);
+}
+
+int32 UDynamicProperty::FindModifierPosition(int32 SlotIndex) const
+{
+	const FDynamicPropertyModifierSlot& Slot = ModifierSlots[SlotIndex];
+
+	if (Slot.bStruct)
+	{
+		const int32 EntryIndex = Algo::LowerBoundBy(StructModifiers, Slot.Key, &FDynamicPropertyStructModifierEntry::Key);
+		return StructModifiers.IsValidIndex(EntryIndex) && StructModifiers[EntryIndex].Key.Slot == SlotIndex ? EntryIndex : INDEX_NONE;
+	}
+
+	const int32 Index = Algo::LowerBound(ModifierOrder, Slot.Key);
+	if (ModifierOrder.IsValidIndex(Index) && ModifierOrder[Index].Slot == SlotIndex)
+	{
+		return Index;
+	}
+
+	// The keys are out of order until a pending refresh is applied
+	return ModifierOrder.IndexOfByPredicate([SlotIndex](const FDynamicPropertyModifierOrderKey& Key) { return Key.Slot == SlotIndex; });
+}
+
+bool UDynamicProperty::RemoveModifierInSlot(int32 SlotIndex)
+{
+	if (!ModifierSlots[SlotIndex].bStruct)
+	{
+		EnsureModifierOrder();
+	}
+
+	const int32 Position = FindModifierPosition(SlotIndex);
+	if (Position == INDEX_NONE)
+	{
+		return false;
+	}
+
+	if (ModifierSlots[SlotIndex].bStruct)
+	{
+		ReleaseStructModifierPoolSlot(StructModifiers[Position]);
+		StructModifiers.RemoveAt(Position);
+	}
+	else
+	{
+		Modifiers.RemoveAt(Position);
+		ModifierOrder.RemoveAt(Position);
+	}
+
+	FreeModifierSlot(SlotIndex);
+
+	return true;
+}
@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertyModifier.h"
+
+bool FDynamicPropertyModifierAdd::GetLinearOp(FModifierLinearOp& OutOp) const
+{
+	OutOp = FModifierLinearOp();
+	OutOp.Offset = AdditiveValue;
+	return true;
+}
+
+bool FDynamicPropertyModifierScale::GetLinearOp(FModifierLinearOp& OutOp) const
+{
+	OutOp = FModifierLinearOp();
+	OutOp.CurrentScale = Multiplier;
+	return true;
+}
+
+bool FDynamicPropertyModifierAddScaledBase::GetLinearOp(FModifierLinearOp& OutOp) const
+{
+	OutOp = FModifierLinearOp();
+	OutOp.BaseScale = BaseMultiplier;
+	return true;
+}
@@ -0,0 +1,356 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicPropertyStore.h"
+#include "DynamicPropertiesBatchEvaluator.h"
+#include "Algo/BinarySearch.h"
+
+FDynamicPropertyHandle FDynamicPropertyStore::Add(FGameplayTag Tag, float BaseValue)
+{
+	check(!TagToIndex.Contains(Tag));
+
+	const int32 Index = Tags.Add(Tag);
+	BaseValues.Add(BaseValue);
+	Values.Add(BaseValue);
+	ModifierStarts.Add(Modifiers.Num());
+	ModifierCounts.Add(0);
+	ModifierCapacities.Add(0);
+	NonLinearModifierCounts.Add(0);
+	Dirty.Add(false);
+	TagToIndex.Add(Tag, Index);
+
+	return FDynamicPropertyHandle(Index, Tag);
+}
+
+void FDynamicPropertyStore::Reserve(int32 NumProperties)
+{
+	TagToIndex.Reserve(NumProperties);
+	Tags.Reserve(NumProperties);
+	BaseValues.Reserve(NumProperties);
+	Values.Reserve(NumProperties);
+	ModifierStarts.Reserve(NumProperties);
+	ModifierCounts.Reserve(NumProperties);
+	ModifierCapacities.Reserve(NumProperties);
+	NonLinearModifierCounts.Reserve(NumProperties);
+	Dirty.Reserve(NumProperties);
+}
+
+bool FDynamicPropertyStore::Remove(FGameplayTag Tag, TArray<UModifier*>* OutModifiers)
+{
+	int32 Index = INDEX_NONE;
+	if (!TagToIndex.RemoveAndCopyValue(Tag, Index))
+	{
+		return false;
+	}
+
+	if (OutModifiers)
+	{
+		GetModifiers(Index, *OutModifiers);
+	}
+
+	const int32 Start = ModifierStarts[Index];
+	const int32 Capacity = ModifierCapacities[Index];
+
+	// The last property takes over the freed index
+	Tags.RemoveAtSwap(Index);
+	BaseValues.RemoveAtSwap(Index);
+	Values.RemoveAtSwap(Index);
+	ModifierStarts.RemoveAtSwap(Index);
+	ModifierCounts.RemoveAtSwap(Index);
+	ModifierCapacities.RemoveAtSwap(Index);
+	NonLinearModifierCounts.RemoveAtSwap(Index);
+	Dirty.RemoveAtSwap(Index);
+
+	if (Tags.IsValidIndex(Index))
+	{
+		TagToIndex.Add(Tags[Index], Index);
+	}
+
+	ReleaseModifierRange(Start, Capacity);
+
+	return true;
+}
+
+void FDynamicPropertyStore::Reset()
+{
+	TagToIndex.Reset();
+	Tags.Reset();
+	BaseValues.Reset();
+	Values.Reset();
+	ModifierStarts.Reset();
+	ModifierCounts.Reset();
+	ModifierCapacities.Reset();
+	NonLinearModifierCounts.Reset();
+	Dirty.Reset();
+	Modifiers.Reset();
+	ModifierOps.Reset();
+	NumUnusedModifiers = 0;
+}
+
+FDynamicPropertyHandle FDynamicPropertyStore::Find(FGameplayTag Tag) const
+{
+	if (const int32* Index = TagToIndex.Find(Tag))
+	{
+		return FDynamicPropertyHandle(*Index, Tag);
+	}
+	return FDynamicPropertyHandle();
+}
+
+bool FDynamicPropertyStore::SetBaseValue(int32 Index, float NewBaseValue)
+{
+	if (FMath::IsNearlyEqual(BaseValues[Index], NewBaseValue))
+	{
+		return false;
+	}
+
+	BaseValues[Index] = NewBaseValue;
+	return true;
+}
+
+bool FDynamicPropertyStore::AddModifier(int32 Index, UModifier* Modifier)
+{
+	if (!Modifier)
+	{
+		return false;
+	}
+
+	if (ModifierCounts[Index] == ModifierCapacities[Index])
+	{
+		GrowModifierRange(Index);
+	}
+
+	// Binary insertion after every modifier with the same or lower priority (lower priority values are applied first)
+	const int32 Start = ModifierStarts[Index];
+	const int32 End = Start + ModifierCounts[Index];
+	const TArrayView<const FStoredModifier> Range(Modifiers.GetData() + Start, ModifierCounts[Index]);
+	const int32 InsertIndex = Start + Algo::UpperBoundBy(Range, Modifier->Priority, &FStoredModifier::Priority);
+
+	// The slack at the end of the range takes the shifted modifiers
+	for (int32 FlatIndex = End; FlatIndex > InsertIndex; --FlatIndex)
+	{
+		Modifiers[FlatIndex] = Modifiers[FlatIndex - 1];
+		ModifierOps[FlatIndex] = ModifierOps[FlatIndex - 1];
+	}
+
+	FStoredModifier& StoredModifier = Modifiers[InsertIndex];
+	StoredModifier.Modifier = Modifier;
+	StoredModifier.Priority = Modifier->Priority;
+	FModifierLinearOp Op;
+	StoredModifier.bIsLinear = Modifier->GetLinearOp(Op);
+	ModifierOps[InsertIndex] = StoredModifier.bIsLinear ? Op : FModifierLinearOp();
+
+	++ModifierCounts[Index];
+	NonLinearModifierCounts[Index] += StoredModifier.bIsLinear ? 0 : 1;
+
+	return true;
+}
+
+bool FDynamicPropertyStore::RemoveModifier(int32 Index, UModifier* Modifier)
+{
+	const int32 Start = ModifierStarts[Index];
+	const int32 End = Start + ModifierCounts[Index];
+	for (int32 FlatIndex = Start; FlatIndex < End; ++FlatIndex)
+	{
+		if (Modifiers[FlatIndex].Modifier == Modifier)
+		{
+			NonLinearModifierCounts[Index] -= Modifiers[FlatIndex].bIsLinear ? 0 : 1;
+			for (int32 NextIndex = FlatIndex + 1; NextIndex < End; ++NextIndex)
+			{
+				Modifiers[NextIndex - 1] = Modifiers[NextIndex];
+				ModifierOps[NextIndex - 1] = ModifierOps[NextIndex];
+			}
+
+			// The freed entry becomes slack and no longer holds on to its modifier
+			Modifiers[End - 1] = FStoredModifier();
+			ModifierOps[End - 1] = FModifierLinearOp();
+			--ModifierCounts[Index];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FDynamicPropertyStore::RefreshModifiers(int32 Index)
+{
+	const int32 Start = ModifierStarts[Index];
+	const int32 End = Start + ModifierCounts[Index];
+
+	TArrayView<FStoredModifier> Range(Modifiers.GetData() + Start, End - Start);
+	for (FStoredModifier& StoredModifier : Range)
+	{
+		StoredModifier.Priority = StoredModifier.Modifier ? StoredModifier.Modifier->Priority : MIN_int32;
+	}
+	Range.StableSort([](const FStoredModifier& A, const FStoredModifier& B)
+	{
+		return A.Priority < B.Priority;
+	});
+
+	NonLinearModifierCounts[Index] = 0;
+	for (int32 FlatIndex = Start; FlatIndex < End; ++FlatIndex)
+	{
+		FStoredModifier& StoredModifier = Modifiers[FlatIndex];
+		FModifierLinearOp Op;
+		StoredModifier.bIsLinear = StoredModifier.Modifier && StoredModifier.Modifier->GetLinearOp(Op);
+		ModifierOps[FlatIndex] = StoredModifier.bIsLinear ? Op : FModifierLinearOp();
+		NonLinearModifierCounts[Index] += StoredModifier.bIsLinear ? 0 : 1;
+	}
+}
+
+void FDynamicPropertyStore::GetModifiers(int32 Index, TArray<UModifier*>& OutModifiers) const
+{
+	const int32 Start = ModifierStarts[Index];
+	const int32 Count = ModifierCounts[Index];
+
+	OutModifiers.Reset(Count);
+	for (int32 FlatIndex = Start; FlatIndex < Start + Count; ++FlatIndex)
+	{
+		OutModifiers.Add(Modifiers[FlatIndex].Modifier);
+	}
+}
+
+float FDynamicPropertyStore::CalculateForBaseValue(int32 Index, float InBaseValue) const
+{
+	float CalculatedValue = InBaseValue;
+
+	const int32 Start = ModifierStarts[Index];
+	const int32 End = Start + ModifierCounts[Index];
+	for (int32 FlatIndex = Start; FlatIndex < End; ++FlatIndex)
+	{
+		const FStoredModifier& StoredModifier = Modifiers[FlatIndex];
+		if (StoredModifier.bIsLinear)
+		{
+			CalculatedValue = ModifierOps[FlatIndex].Apply(InBaseValue, CalculatedValue);
+		}
+		else if (StoredModifier.Modifier)
+		{
+			CalculatedValue = StoredModifier.Modifier->ApplyInContainer(InBaseValue, CalculatedValue, Owner);
+		}
+	}
+
+	return CalculatedValue;
+}
+
+bool FDynamicPropertyStore::Recalculate(int32 Index, float& OutOldValue)
+{
+	OutOldValue = Values[Index];
+	Values[Index] = CalculateForBaseValue(Index, BaseValues[Index]);
+
+	return !FMath::IsNearlyEqual(OutOldValue, Values[Index]);
+}
+
+void FDynamicPropertyStore::RecalculateAll(TArray<int32>& OutChangedIndices, TArray<float>& OutOldValues)
+{
+	const TArray<float> OldValues = Values;
+
+	// Every stack goes through the kernel, properties with Blueprint modifiers are then redone on the generic path
+	FDynamicPropertiesBatchEvaluator::EvaluateStacks(BaseValues, ModifierOps, ModifierStarts, ModifierCounts, Values);
+
+	OutChangedIndices.Reset();
+	OutOldValues.Reset();
+	for (int32 Index = 0; Index < Values.Num(); ++Index)
+	{
+		if (NonLinearModifierCounts[Index] > 0)
+		{
+			Values[Index] = CalculateForBaseValue(Index, BaseValues[Index]);
+		}
+
+		if (!FMath::IsNearlyEqual(OldValues[Index], Values[Index]))
+		{
+			OutChangedIndices.Add(Index);
+			OutOldValues.Add(OldValues[Index]);
+		}
+	}
+
+	Dirty.Init(false, Values.Num());
+}
+
+SIZE_T FDynamicPropertyStore::GetAllocatedSize() const
+{
+	return TagToIndex.GetAllocatedSize()
+		+ Tags.GetAllocatedSize()
+		+ BaseValues.GetAllocatedSize()
+		+ Values.GetAllocatedSize()
+		+ ModifierStarts.GetAllocatedSize()
+		+ ModifierCounts.GetAllocatedSize()
+		+ ModifierCapacities.GetAllocatedSize()
+		+ NonLinearModifierCounts.GetAllocatedSize()
+		+ Dirty.GetAllocatedSize()
+		+ Modifiers.GetAllocatedSize()
+		+ ModifierOps.GetAllocatedSize();
+}
+
+void FDynamicPropertyStore::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (FStoredModifier& StoredModifier : Modifiers)
+	{
+		Collector.AddReferencedObject(StoredModifier.Modifier);
+	}
+}
+
+void FDynamicPropertyStore::GrowModifierRange(int32 Index)
+{
+	const int32 Start = ModifierStarts[Index];
+	const int32 Count = ModifierCounts[Index];
+	const int32 Capacity = ModifierCapacities[Index];
+	const int32 NewCapacity = FMath::Max(4, Capacity * 2);
+
+	// The last range grows in place
+	if (Start + Capacity == Modifiers.Num())
+	{
+		Modifiers.AddDefaulted(NewCapacity - Capacity);
+		ModifierOps.AddDefaulted(NewCapacity - Capacity);
+		ModifierCapacities[Index] = NewCapacity;
+		return;
+	}
+
+	const int32 NewStart = Modifiers.Num();
+	Modifiers.AddDefaulted(NewCapacity);
+	ModifierOps.AddDefaulted(NewCapacity);
+	for (int32 Offset = 0; Offset < Count; ++Offset)
+	{
+		Modifiers[NewStart + Offset] = Modifiers[Start + Offset];
+		ModifierOps[NewStart + Offset] = ModifierOps[Start + Offset];
+	}
+
+	ModifierStarts[Index] = NewStart;
+	ModifierCapacities[Index] = NewCapacity;
+	ReleaseModifierRange(Start, Capacity);
+}
+
+void FDynamicPropertyStore::ReleaseModifierRange(int32 Start, int32 Capacity)
+{
+	for (int32 FlatIndex = Start; FlatIndex < Start + Capacity; ++FlatIndex)
+	{
+		Modifiers[FlatIndex] = FStoredModifier();
+		ModifierOps[FlatIndex] = FModifierLinearOp();
+	}
+
+	// Packing costs a pass over every modifier, waiting for half of them to be unused keeps it amortized
+	NumUnusedModifiers += Capacity;
+	if (NumUnusedModifiers > 64 && NumUnusedModifiers * 2 > Modifiers.Num())
+	{
+		PackModifierRanges();
+	}
+}
+
+void FDynamicPropertyStore::PackModifierRanges()
+{
+	TArray<FStoredModifier> PackedModifiers;
+	TArray<FModifierLinearOp> PackedOps;
+	PackedModifiers.Reserve(Modifiers.Num() - NumUnusedModifiers);
+	PackedOps.Reserve(Modifiers.Num() - NumUnusedModifiers);
+
+	// Ranges keep their slack
+	for (int32 Index = 0; Index < ModifierStarts.Num(); ++Index)
+	{
+		const int32 Start = ModifierStarts[Index];
+		const int32 Capacity = ModifierCapacities[Index];
+		ModifierStarts[Index] = PackedModifiers.Num();
+		PackedModifiers.Append(Modifiers.GetData() + Start, Capacity);
+		PackedOps.Append(ModifierOps.GetData() + Start, Capacity);
+	}
+
+	Modifiers = MoveTemp(PackedModifiers);
+	ModifierOps = MoveTemp(PackedOps);
+	NumUnusedModifiers = 0;
+}
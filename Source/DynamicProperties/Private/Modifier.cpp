@@ -1,6 +1,22 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Modifier.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/ObjectKey.h"
+
+namespace ModifierClassTraits
+{
+	/** Apply isn't overridden in Blueprint */
+	constexpr uint8 ApplyNative = 1 << 0;
+
+	/** The nearest native class is the one declaring the linear form */
+	constexpr uint8 DeclaresLinearOp = 1 << 1;
+
+	/** Traits by class, they take a function lookup and a walk up the class chain to find */
+	FRWLock CacheLock;
+	TMap<FObjectKey, uint8> Cache;
+	bool bReinstanceHandlerRegistered = false;
+}
 
 UModifier::UModifier()
 {
@@ -13,3 +29,80 @@ float UModifier::Apply_Implementation(float BaseValue, float CurrentValue)
 	return CurrentValue;
 }
 
+bool UModifier::GetLinearOp(FModifierLinearOp& OutOp) const
+{
+	using namespace ModifierClassTraits;
+
+	const uint8 Traits = GetClassTraits();
+	if ((Traits & (ApplyNative | DeclaresLinearOp)) != (ApplyNative | DeclaresLinearOp))
+	{
+		return false;
+	}
+
+	return GetNativeLinearOp(OutOp);
+}
+
+bool UModifier::IsApplyNative() const
+{
+	return (GetClassTraits() & ModifierClassTraits::ApplyNative) != 0;
+}
+
+uint8 UModifier::GetClassTraits() const
+{
+	using namespace ModifierClassTraits;
+
+	const UClass* Class = GetClass();
+	const FObjectKey ClassKey(Class);
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		if (const uint8* CachedTraits = Cache.Find(ClassKey))
+		{
+			return *CachedTraits;
+		}
+	}
+
+	// A Blueprint override of Apply replaces the native implementation the linear form describes
+	uint8 Traits = 0;
+	const UFunction* ApplyFunction = Class->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(UModifier, Apply));
+	if (ApplyFunction && ApplyFunction->HasAnyFunctionFlags(FUNC_Native))
+	{
+		Traits |= ApplyNative;
+	}
+
+	// A native subclass overriding Apply_Implementation isn't described by the linear form it inherits, so the nearest
+	// native class, the one implementing Apply, has to be the one declaring the linear form
+	const UClass* NativeClass = Class;
+	while (NativeClass && !NativeClass->HasAnyClassFlags(CLASS_Native))
+	{
+		NativeClass = NativeClass->GetSuperClass();
+	}
+
+	if (NativeClass == GetNativeLinearOpClass())
+	{
+		Traits |= DeclaresLinearOp;
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
+	Cache.Add(ClassKey, Traits);
+
+#if WITH_EDITOR
+	// Compiling a Blueprint regenerates its class in place, so what was found for it may no longer hold
+	if (!bReinstanceHandlerRegistered)
+	{
+		bReinstanceHandlerRegistered = true;
+		FCoreUObjectDelegates::OnObjectsReinstanced.AddLambda([](const TMap<UObject*, UObject*>&)
+		{
+			FWriteScopeLock ResetLock(CacheLock);
+			Cache.Reset();
+		});
+	}
+#endif
+
+	return Traits;
+}
+
+bool UModifier::GetNativeLinearOp(FModifierLinearOp& OutOp) const
+{
+	// Modifiers are not linear unless a subclass says so
+	return false;
+}
@@ -12,3 +12,9 @@ float UModifierAdd::Apply_Implementation(float BaseValue, float CurrentValue)
 	return CurrentValue + AdditiveValue;
 }
 
+bool UModifierAdd::GetNativeLinearOp(FModifierLinearOp& OutOp) const
+{
+	OutOp = FModifierLinearOp();
+	OutOp.Offset = AdditiveValue;
+	return true;
+}
@@ -12,3 +12,9 @@ float UModifierAddScaledBase::Apply_Implementation(float BaseValue, float Curren
 	return CurrentValue + (BaseValue * BaseMultiplier);
 }
 
+bool UModifierAddScaledBase::GetNativeLinearOp(FModifierLinearOp& OutOp) const
+{
+	OutOp = FModifierLinearOp();
+	OutOp.BaseScale = BaseMultiplier;
+	return true;
+}
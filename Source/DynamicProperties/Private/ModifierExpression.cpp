@@ -0,0 +1,561 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ModifierExpression.h"
+#include "DynamicPropertiesLog.h"
+#include "DynamicPropertiesContainer.h"
+#include "GameFramework/Actor.h"
+
+namespace ModifierExpression
+{
+	/**
+	 * Recursive descent parser emitting bytecode directly: each sub-expression is evaluated into the register matching its depth
+	 */
+	class FCompiler
+	{
+	public:
+		FCompiler(const FString& InSource, TArray<FModifierExpressionInstruction>& InProgram, TArray<float>& InConstants, TArray<FGameplayTag>& InTags)
+			: Source(InSource)
+			, Program(InProgram)
+			, Constants(InConstants)
+			, Tags(InTags)
+		{
+		}
+
+		bool Compile(FString& OutError)
+		{
+			SkipWhitespace();
+			if (Peek() == TEXT('\0'))
+			{
+				OutError = TEXT("Expression is empty");
+				return false;
+			}
+
+			if (ParseExpression(0))
+			{
+				SkipWhitespace();
+				if (Peek() != TEXT('\0'))
+				{
+					Fail(FString::Printf(TEXT("Unexpected '%c'"), Peek()));
+				}
+			}
+
+			OutError = Error;
+			return Error.IsEmpty();
+		}
+
+	private:
+		const FString& Source;
+		TArray<FModifierExpressionInstruction>& Program;
+		TArray<float>& Constants;
+		TArray<FGameplayTag>& Tags;
+		int32 Position = 0;
+		int32 Nesting = 0;
+		FString Error;
+
+		/** Counts a level of nesting while in scope */
+		struct FNestingScope
+		{
+			explicit FNestingScope(int32& InNesting)
+				: Nesting(InNesting)
+			{
+				++Nesting;
+			}
+
+			~FNestingScope()
+			{
+				--Nesting;
+			}
+
+			int32& Nesting;
+		};
+
+		bool CheckNesting()
+		{
+			if (Nesting > UModifierExpression::MaxNesting)
+			{
+				return Fail(TEXT("Expression is nested too deeply"));
+			}
+			return true;
+		}
+
+		TCHAR Peek() const { return Position < Source.Len() ? Source[Position] : TEXT('\0'); }
+
+		void SkipWhitespace()
+		{
+			while (FChar::IsWhitespace(Peek()))
+			{
+				++Position;
+			}
+		}
+
+		bool Match(TCHAR Character)
+		{
+			SkipWhitespace();
+			if (Peek() == Character)
+			{
+				++Position;
+				return true;
+			}
+			return false;
+		}
+
+		bool Expect(TCHAR Character)
+		{
+			if (!Match(Character))
+			{
+				return Fail(FString::Printf(TEXT("Expected '%c' at position %d"), Character, Position));
+			}
+			return true;
+		}
+
+		bool Fail(const FString& Message)
+		{
+			if (Error.IsEmpty())
+			{
+				Error = Message;
+			}
+			return false;
+		}
+
+		bool Emit(EModifierExpressionOp Op, int32 Target, int32 NumOperands, int32 Operand = 0)
+		{
+			if (Target + NumOperands > UModifierExpression::MaxRegisters)
+			{
+				return Fail(TEXT("Expression is nested too deeply"));
+			}
+
+			FModifierExpressionInstruction& Instruction = Program.AddDefaulted_GetRef();
+			Instruction.Op = Op;
+			Instruction.Target = static_cast<uint8>(Target);
+			Instruction.Operand = static_cast<uint16>(Operand);
+			return true;
+		}
+
+		// Expression := Term (('+' | '-') Term)*
+		bool ParseExpression(int32 Target)
+		{
+			if (!ParseTerm(Target))
+			{
+				return false;
+			}
+
+			while (true)
+			{
+				if (Match(TEXT('+')))
+				{
+					if (!ParseTerm(Target + 1) || !Emit(EModifierExpressionOp::Add, Target, 2))
+					{
+						return false;
+					}
+				}
+				else if (Match(TEXT('-')))
+				{
+					if (!ParseTerm(Target + 1) || !Emit(EModifierExpressionOp::Subtract, Target, 2))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					return true;
+				}
+			}
+		}
+
+		// Term := Unary (('*' | '/') Unary)*
+		bool ParseTerm(int32 Target)
+		{
+			if (!ParseUnary(Target))
+			{
+				return false;
+			}
+
+			while (true)
+			{
+				if (Match(TEXT('*')))
+				{
+					if (!ParseUnary(Target + 1) || !Emit(EModifierExpressionOp::Multiply, Target, 2))
+					{
+						return false;
+					}
+				}
+				else if (Match(TEXT('/')))
+				{
+					if (!ParseUnary(Target + 1) || !Emit(EModifierExpressionOp::Divide, Target, 2))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					return true;
+				}
+			}
+		}
+
+		// Unary := '-' Unary | Primary
+		bool ParseUnary(int32 Target)
+		{
+			if (Match(TEXT('-')))
+			{
+				// Signs are applied in place, so chained signs are bounded by the nesting limit rather than the registers
+				const FNestingScope NestingScope(Nesting);
+				return CheckNesting() && ParseUnary(Target) && Emit(EModifierExpressionOp::Negate, Target, 1);
+			}
+
+			return ParsePrimary(Target);
+		}
+
+		// Primary := Number | '(' Expression ')' | '[' Tag ']' | Identifier | Function '(' Arguments ')'
+		bool ParsePrimary(int32 Target)
+		{
+			if (Target >= UModifierExpression::MaxRegisters)
+			{
+				return Fail(TEXT("Expression is nested too deeply"));
+			}
+
+			SkipWhitespace();
+			const TCHAR Character = Peek();
+
+			if (FChar::IsDigit(Character) || Character == TEXT('.'))
+			{
+				return ParseNumber(Target);
+			}
+
+			if (Match(TEXT('(')))
+			{
+				const FNestingScope NestingScope(Nesting);
+				return CheckNesting() && ParseExpression(Target) && Expect(TEXT(')'));
+			}
+
+			if (Match(TEXT('[')))
+			{
+				return ParseTag(Target);
+			}
+
+			if (FChar::IsAlpha(Character) || Character == TEXT('_'))
+			{
+				return ParseIdentifier(Target);
+			}
+
+			return Fail(Character == TEXT('\0') ? FString(TEXT("Unexpected end of expression")) : FString::Printf(TEXT("Unexpected '%c' at position %d"), Character, Position));
+		}
+
+		bool ParseNumber(int32 Target)
+		{
+			const int32 Start = Position;
+			int32 NumDigits = 0;
+			int32 NumPoints = 0;
+			while (FChar::IsDigit(Peek()) || Peek() == TEXT('.'))
+			{
+				NumDigits += FChar::IsDigit(Peek()) ? 1 : 0;
+				NumPoints += Peek() == TEXT('.') ? 1 : 0;
+				++Position;
+			}
+
+			const FString Number = Source.Mid(Start, Position - Start);
+			if (NumDigits == 0 || NumPoints > 1)
+			{
+				return Fail(FString::Printf(TEXT("Invalid number '%s'"), *Number));
+			}
+
+			const float Value = FCString::Atof(*Number);
+			int32 ConstantIndex = Constants.IndexOfByKey(Value);
+			if (ConstantIndex == INDEX_NONE)
+			{
+				ConstantIndex = Constants.Add(Value);
+			}
+
+			return Emit(EModifierExpressionOp::LoadConstant, Target, 1, ConstantIndex);
+		}
+
+		bool ParseTag(int32 Target)
+		{
+			const int32 Start = Position;
+			while (Peek() != TEXT(']') && Peek() != TEXT('\0'))
+			{
+				++Position;
+			}
+
+			const FString TagName = Source.Mid(Start, Position - Start).TrimStartAndEnd();
+			if (!Expect(TEXT(']')))
+			{
+				return false;
+			}
+
+			const FGameplayTag Tag = FGameplayTag::RequestGameplayTag(FName(*TagName), false);
+			if (!Tag.IsValid())
+			{
+				return Fail(FString::Printf(TEXT("Unknown gameplay tag '%s'"), *TagName));
+			}
+
+			return Emit(EModifierExpressionOp::LoadProperty, Target, 1, Tags.AddUnique(Tag));
+		}
+
+		bool ParseIdentifier(int32 Target)
+		{
+			const int32 Start = Position;
+			while (FChar::IsAlnum(Peek()) || Peek() == TEXT('_'))
+			{
+				++Position;
+			}
+			const FString Name = Source.Mid(Start, Position - Start);
+
+			if (Name == TEXT("Base") || Name == TEXT("BaseValue"))
+			{
+				return Emit(EModifierExpressionOp::LoadBase, Target, 1);
+			}
+
+			if (Name == TEXT("Current") || Name == TEXT("CurrentValue"))
+			{
+				return Emit(EModifierExpressionOp::LoadCurrent, Target, 1);
+			}
+
+			struct FFunction
+			{
+				const TCHAR* Name;
+				EModifierExpressionOp Op;
+				int32 NumArguments;
+			};
+
+			static const FFunction Functions[] =
+			{
+				{ TEXT("min"), EModifierExpressionOp::Min, 2 },
+				{ TEXT("max"), EModifierExpressionOp::Max, 2 },
+				{ TEXT("clamp"), EModifierExpressionOp::Clamp, 3 },
+				{ TEXT("abs"), EModifierExpressionOp::Abs, 1 },
+				{ TEXT("floor"), EModifierExpressionOp::Floor, 1 },
+				{ TEXT("ceil"), EModifierExpressionOp::Ceil, 1 },
+				{ TEXT("round"), EModifierExpressionOp::Round, 1 },
+				{ TEXT("sqrt"), EModifierExpressionOp::Sqrt, 1 },
+			};
+
+			for (const FFunction& Function : Functions)
+			{
+				if (Name == Function.Name)
+				{
+					if (!Expect(TEXT('(')))
+					{
+						return false;
+					}
+
+					for (int32 Argument = 0; Argument < Function.NumArguments; ++Argument)
+					{
+						if ((Argument > 0 && !Expect(TEXT(','))) || !ParseExpression(Target + Argument))
+						{
+							return false;
+						}
+					}
+
+					return Expect(TEXT(')')) && Emit(Function.Op, Target, Function.NumArguments);
+				}
+			}
+
+			return Fail(FString::Printf(TEXT("Unknown identifier '%s'"), *Name));
+		}
+	};
+}
+
+UModifierExpression::UModifierExpression()
+{
+}
+
+void UModifierExpression::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	bApplyNative = IsApplyNative();
+}
+
+void UModifierExpression::PostLoad()
+{
+	Super::PostLoad();
+
+	Compile();
+}
+
+void UModifierExpression::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	if (Ar.IsCountingMemory())
+	{
+		const SIZE_T NativeSize = GetAllocatedSize();
+		Ar.CountBytes(NativeSize, NativeSize);
+	}
+}
+
+#if WITH_EDITOR
+void UModifierExpression::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UModifierExpression, Expression))
+	{
+		Compile();
+	}
+}
+#endif
+
+float UModifierExpression::Apply_Implementation(float BaseValue, float CurrentValue)
+{
+	// Modifiers spawned at runtime with their formula set on spawn are compiled on first use
+	if (!bCompileAttempted)
+	{
+		Compile();
+	}
+
+	float Result = CurrentValue;
+	return Evaluate(BaseValue, CurrentValue, Result) ? Result : CurrentValue;
+}
+
+float UModifierExpression::ApplyInContainer(float BaseValue, float CurrentValue, UDynamicPropertiesContainer* InContainer)
+{
+	// Blueprint subclasses overriding Apply keep their override
+	if (!InContainer || !bApplyNative)
+	{
+		return Apply(BaseValue, CurrentValue);
+	}
+
+	if (!bCompileAttempted)
+	{
+		Compile();
+	}
+
+	float Result = CurrentValue;
+	return Evaluate(BaseValue, CurrentValue, Result, InContainer) ? Result : CurrentValue;
+}
+
+void UModifierExpression::GetPropertyDependencies(TArray<FGameplayTag>& OutTags) const
+{
+	// Containers ask as soon as the modifier is applied, which may be before its first use
+	if (!bCompileAttempted)
+	{
+		const_cast<UModifierExpression*>(this)->Compile();
+	}
+
+	OutTags.Append(ReferencedTags);
+}
+
+SIZE_T UModifierExpression::GetAllocatedSize() const
+{
+	return Program.GetAllocatedSize() + Constants.GetAllocatedSize() + ReferencedTags.GetAllocatedSize();
+}
+
+bool UModifierExpression::SetExpression(const FString& NewExpression)
+{
+	Expression = NewExpression;
+	return Compile();
+}
+
+bool UModifierExpression::Compile()
+{
+	bCompileAttempted = true;
+	bCompiled = false;
+	Program.Reset();
+	Constants.Reset();
+	ReferencedTags.Reset();
+	CompileError.Reset();
+
+	ModifierExpression::FCompiler Compiler(Expression, Program, Constants, ReferencedTags);
+	if (!Compiler.Compile(CompileError))
+	{
+		UE_LOG(LogDynamicProperties, Warning, TEXT("UModifierExpression::Compile - %s in '%s'. The modifier leaves values unchanged."), *CompileError, *Expression);
+		Program.Reset();
+		return false;
+	}
+
+	Program.Shrink();
+	Constants.Shrink();
+	bCompiled = true;
+	return true;
+}
+
+bool UModifierExpression::Evaluate(float BaseValue, float CurrentValue, float& OutValue, UDynamicPropertiesContainer* ReadContainer) const
+{
+	if (!bCompiled)
+	{
+		return false;
+	}
+
+	UDynamicPropertiesContainer* PropertyContainer = ReferencedTags.Num() > 0 ? (ReadContainer ? ReadContainer : GetContainer()) : nullptr;
+
+	float Registers[MaxRegisters];
+	for (const FModifierExpressionInstruction& Instruction : Program)
+	{
+		float* R = Registers + Instruction.Target;
+		switch (Instruction.Op)
+		{
+		case EModifierExpressionOp::LoadConstant:
+			R[0] = Constants[Instruction.Operand];
+			break;
+		case EModifierExpressionOp::LoadBase:
+			R[0] = BaseValue;
+			break;
+		case EModifierExpressionOp::LoadCurrent:
+			R[0] = CurrentValue;
+			break;
+		case EModifierExpressionOp::LoadProperty:
+			R[0] = PropertyContainer ? PropertyContainer->GetPropertyValueOrDefault(ReferencedTags[Instruction.Operand], 0.0f) : 0.0f;
+			break;
+		case EModifierExpressionOp::Add:
+			R[0] = R[0] + R[1];
+			break;
+		case EModifierExpressionOp::Subtract:
+			R[0] = R[0] - R[1];
+			break;
+		case EModifierExpressionOp::Multiply:
+			R[0] = R[0] * R[1];
+			break;
+		case EModifierExpressionOp::Divide:
+			R[0] = R[1] != 0.0f ? R[0] / R[1] : 0.0f;
+			break;
+		case EModifierExpressionOp::Negate:
+			R[0] = -R[0];
+			break;
+		case EModifierExpressionOp::Min:
+			R[0] = FMath::Min(R[0], R[1]);
+			break;
+		case EModifierExpressionOp::Max:
+			R[0] = FMath::Max(R[0], R[1]);
+			break;
+		case EModifierExpressionOp::Clamp:
+			R[0] = FMath::Clamp(R[0], R[1], R[2]);
+			break;
+		case EModifierExpressionOp::Abs:
+			R[0] = FMath::Abs(R[0]);
+			break;
+		case EModifierExpressionOp::Floor:
+			R[0] = FMath::FloorToFloat(R[0]);
+			break;
+		case EModifierExpressionOp::Ceil:
+			R[0] = FMath::CeilToFloat(R[0]);
+			break;
+		case EModifierExpressionOp::Round:
+			R[0] = FMath::RoundToFloat(R[0]);
+			break;
+		case EModifierExpressionOp::Sqrt:
+			R[0] = R[0] > 0.0f ? FMath::Sqrt(R[0]) : 0.0f;
+			break;
+		}
+	}
+
+	OutValue = Registers[0];
+	return true;
+}
+
+UDynamicPropertiesContainer* UModifierExpression::GetContainer() const
+{
+	if (UDynamicPropertiesContainer* ExplicitContainer = Container.Get())
+	{
+		return ExplicitContainer;
+	}
+
+	if (UDynamicPropertiesContainer* OuterContainer = GetTypedOuter<UDynamicPropertiesContainer>())
+	{
+		return OuterContainer;
+	}
+
+	const AActor* OwningActor = GetTypedOuter<AActor>();
+	return OwningActor ? OwningActor->FindComponentByClass<UDynamicPropertiesContainer>() : nullptr;
+}
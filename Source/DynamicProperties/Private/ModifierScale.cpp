@@ -12,3 +12,9 @@ float UModifierScale::Apply_Implementation(float BaseValue, float CurrentValue)
 	return CurrentValue * Multiplier;
 }
 
+bool UModifierScale::GetNativeLinearOp(FModifierLinearOp& OutOp) const
+{
+	OutOp = FModifierLinearOp();
+	OutOp.CurrentScale = Multiplier;
+	return true;
+}
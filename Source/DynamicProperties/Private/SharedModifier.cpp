@@ -0,0 +1,106 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SharedModifier.h"
+#include "DynamicPropertiesContainer.h"
+
+USharedModifier::USharedModifier()
+{
+}
+
+float USharedModifier::Apply_Implementation(float BaseValue, float CurrentValue)
+{
+	return Modifier ? Modifier->Apply(BaseValue, CurrentValue) : CurrentValue;
+}
+
+float USharedModifier::ApplyInContainer(float BaseValue, float CurrentValue, UDynamicPropertiesContainer* Container)
+{
+	// Each subscriber evaluates the wrapped modifier against its own container
+	if (!IsApplyNative())
+	{
+		return Apply(BaseValue, CurrentValue);
+	}
+
+	return Modifier ? Modifier->ApplyInContainer(BaseValue, CurrentValue, Container) : CurrentValue;
+}
+
+void USharedModifier::GetPropertyDependencies(TArray<FGameplayTag>& OutTags) const
+{
+	if (Modifier)
+	{
+		Modifier->GetPropertyDependencies(OutTags);
+	}
+}
+
+bool USharedModifier::GetNativeLinearOp(FModifierLinearOp& OutOp) const
+{
+	// Linear as long as the wrapped modifier is, no modifier at all is the identity
+	if (!Modifier)
+	{
+		OutOp = FModifierLinearOp();
+		return true;
+	}
+
+	return Modifier->GetLinearOp(OutOp);
+}
+
+void USharedModifier::SetModifier(UModifier* NewModifier)
+{
+	if (Modifier != NewModifier)
+	{
+		Modifier = NewModifier;
+		NotifyModifierChanged();
+	}
+}
+
+void USharedModifier::NotifyModifierChanged()
+{
+	// Subscriptions of destroyed containers are dropped on the way
+	Subscriptions.RemoveAll([](const FSharedModifierSubscription& Subscription)
+	{
+		return !Subscription.Container.IsValid();
+	});
+
+	// One batch per container, opened before any of its properties is refreshed
+	TSet<UDynamicPropertiesContainer*> Containers;
+	Containers.Reserve(Subscriptions.Num());
+	for (const FSharedModifierSubscription& Subscription : Subscriptions)
+	{
+		UDynamicPropertiesContainer* Container = Subscription.Container.Get();
+		bool bAlreadyBatching = false;
+		Containers.Add(Container, &bAlreadyBatching);
+		if (!bAlreadyBatching)
+		{
+			Container->BeginBatch();
+		}
+	}
+
+	for (const FSharedModifierSubscription& Subscription : Subscriptions)
+	{
+		Subscription.Container->RefreshPropertyModifiers(Subscription.PropertyTag);
+	}
+
+	for (UDynamicPropertiesContainer* Container : Containers)
+	{
+		Container->EndBatch();
+	}
+}
+
+void USharedModifier::AddSubscriber(UDynamicPropertiesContainer* Container, FGameplayTag PropertyTag)
+{
+	FSharedModifierSubscription& Subscription = Subscriptions.AddDefaulted_GetRef();
+	Subscription.Container = Container;
+	Subscription.PropertyTag = PropertyTag;
+}
+
+void USharedModifier::RemoveSubscriber(UDynamicPropertiesContainer* Container, FGameplayTag PropertyTag)
+{
+	const int32 Index = Subscriptions.IndexOfByPredicate([Container, PropertyTag](const FSharedModifierSubscription& Subscription)
+	{
+		return Subscription.Container == Container && Subscription.PropertyTag == PropertyTag;
+	});
+
+	if (Index != INDEX_NONE)
+	{
+		Subscriptions.RemoveAtSwap(Index);
+	}
+}
@@ -10,6 +10,7 @@
  * Actor component that manages dynamic properties with cascading/hierarchical tag relationships
  * When a property changes, it updates the base values of all direct child properties
  * For example: changing "A" will update base value of "A.B", which then cascades to "A.B.C"
+ * The whole subtree is recalculated in a single depth-ordered pass and its events are fired afterwards, parents first
  */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class DYNAMICPROPERTIES_API UCascadeDynamicPropertiesContainer : public UDynamicPropertiesContainer
@@ -19,6 +20,9 @@ class DYNAMICPROPERTIES_API UCascadeDynamicPropertiesContainer : public UDynamic
 public:
 	UCascadeDynamicPropertiesContainer();
 
+	virtual void PostLoad() override;
+	virtual SIZE_T GetAllocatedSize() const override;
+
 	/**
 	 * Gets the value of a property with cascade calculation
 	 * Walks up the tag hierarchy to find parent properties and uses their values as base
@@ -34,46 +38,113 @@ protected:
 	 */
 	virtual void OnPropertyAddedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property) override;
 
+	/**
+	 * Override to keep the hierarchy index in sync when properties are removed
+	 */
+	virtual void OnPropertyRemovedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property) override;
+
 	/**
 	 * Override to add cascade handling when property values change
 	 */
 	virtual void OnPropertyValueChangedInternal(FGameplayTag PropertyTag, float OldValue, float NewValue) override;
 
+	/**
+	 * Override to order parents before their children, so each cascade level is applied once
+	 */
+	virtual void GetPropertiesInUpdateOrder(TArray<FGameplayTag>& OutTags) const override;
+
+	/**
+	 * Override to mark cascade descendants of a dirty property dirty as well
+	 */
+	virtual void OnPropertyDirtyInternal(FGameplayTag PropertyTag) override;
+
+	/**
+	 * Override to flush the nearest parent before a property is recalculated, since it provides the base value
+	 */
+	virtual void FlushPropertyDependencies(FGameplayTag PropertyTag) override;
+
+	/**
+	 * Override to precompute parents before children, feeding each parent's predicted value into its children's base value
+	 */
+	virtual int32 PrecomputePendingValues() override;
+
+	/**
+	 * Override to rebuild the hierarchy index for the restored properties
+	 */
+	virtual void OnPropertiesRestoredInternal() override;
+
+	/**
+	 * Override to index the added properties and re-base them, and the existing properties below them, in one depth-ordered pass
+	 */
+	virtual void OnPropertiesInitializedInternal(const TArray<FGameplayTag>& AddedTags) override;
+
 private:
+	/** Nearest existing ancestor property tag for every property in the container (empty tag for roots) */
+	TMap<FGameplayTag, FGameplayTag> ParentPropertyTags;
+
+	/** Properties whose nearest existing ancestor is the key tag (roots are stored under the empty tag) */
+	TMap<FGameplayTag, TArray<FGameplayTag>> ChildPropertyTags;
+
+	/**
+	 * Nearest ancestor property of queried tags that have no property of their own (empty tag when there is none)
+	 * Only depends on which properties exist, so it is cleared whenever one is added or removed
+	 */
+	mutable TMap<FGameplayTag, FGameplayTag> ResolvedAncestorTags;
+
+	/** A descendant value change applied by a cascade pass, reported once the pass is complete */
+	struct FCascadeValueChange
+	{
+		FGameplayTag PropertyTag;
+		float OldValue;
+		float NewValue;
+	};
 
 	/**
-	 * Updates the base value of all direct child properties when a parent changes
+	 * Updates the base values of the whole subtree below a changed parent in one breadth-first pass
+	 * Each descendant is recalculated once, in depth order, without firing events
 	 * @param ParentTag The parent tag that changed
 	 * @param NewParentValue The new value of the parent
+	 * @param OutChanges Array filled with the descendants whose value changed, in depth order
 	 */
-	void UpdateChildPropertiesBaseValue(FGameplayTag ParentTag, float NewParentValue);
+	void UpdateChildPropertiesBaseValue(FGameplayTag ParentTag, float NewParentValue, TArray<FCascadeValueChange, TInlineAllocator<16>>& OutChanges);
 
 	/**
-	 * Finds the nearest parent property in the hierarchy
+	 * Finds the nearest parent property in the hierarchy, memoized for tags without a property of their own
 	 * @param ChildTag The tag to find parent for
-	 * @return The nearest parent property, or nullptr if none found
+	 * @return The tag of the nearest parent property, or an empty tag if none found
 	 */
-	UDynamicProperty* FindNearestParentProperty(FGameplayTag ChildTag);
+	FGameplayTag FindNearestParentPropertyTag(FGameplayTag ChildTag) const;
 
 	/**
-	 * Gets all direct child tags of a parent tag from the properties map
+	 * Finds the tag of the nearest existing ancestor property by walking the gameplay tag tree
+	 * @param ChildTag The tag to find parent for
+	 * @return The nearest ancestor property tag, or an empty tag if none exists
+	 */
+	FGameplayTag FindNearestParentTag(FGameplayTag ChildTag) const;
+
+	/**
+	 * Gets all children to update when a parent changes: properties with no intermediate property between them and the parent
 	 * @param ParentTag The parent tag
-	 * @param OutChildTags Array to fill with direct child tags
+	 * @return The indexed child tags, or nullptr if the parent has none
 	 */
-	void GetDirectChildTags(FGameplayTag ParentTag, TArray<FGameplayTag>& OutChildTags);
+	const TArray<FGameplayTag>* GetChildrenToUpdate(FGameplayTag ParentTag) const { return ChildPropertyTags.Find(ParentTag); }
 
 	/**
-	 * Counts the depth of a gameplay tag (number of dots + 1)
-	 * @param Tag The tag to measure
-	 * @return The depth of the tag
+	 * Inserts a property into the hierarchy index, adopting existing descendants of its nearest parent
+	 * @param PropertyTag The tag of the added property
 	 */
-	static int32 GetTagDepth(const FString& TagString);
+	void AddToHierarchyIndex(FGameplayTag PropertyTag);
 
 	/**
-	 * Gets all non-direct children that don't have intermediate nodes in the hierarchy
-	 * @param ParentTag The parent tag
-	 * @param OutChildTags Array to fill with non-direct child tags without intermediate nodes
+	 * Rebuilds the hierarchy index from scratch for properties that were not added through OnPropertyAddedInternal
 	 */
-	void GetChildrenToUpdate(FGameplayTag ParentTag, TArray<FGameplayTag>& OutChildTags);
-};
+	void RebuildHierarchyIndex();
 
+	/**
+	 * Removes a property from the hierarchy index, handing its children over to its nearest parent
+	 * @param PropertyTag The tag of the removed property
+	 * @param OutAdoptedChildren Array filled with the children that moved to the removed property's parent
+	 * @return The tag of the removed property's nearest parent, or an empty tag if it was a root
+	 */
+	FGameplayTag RemoveFromHierarchyIndex(FGameplayTag PropertyTag, TArray<FGameplayTag>& OutAdoptedChildren);
+};
@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modifier.h"
+
+/**
+ * A linear modifier stack collapsed into a single affine form: Value = BaseValue * Scale + Offset
+ */
+struct FModifierAffineForm
+{
+	float Scale = 1.0f;
+	float Offset = 0.0f;
+};
+
+/**
+ * Vectorized evaluation of many linear modifier stacks at once
+ * Uses the engine vector register abstraction (SSE/NEON), which falls back to scalar code on targets without vector intrinsics
+ */
+struct DYNAMICPROPERTIES_API FDynamicPropertiesBatchEvaluator
+{
+	/**
+	 * Evaluates one linear modifier stack per property, four properties per vector, applying ops in the same order
+	 * and with the same arithmetic as FModifierLinearOp::Apply
+	 * @param BaseValues Base value of each property
+	 * @param Ops Flattened ops of all properties
+	 * @param OpStarts Index of the first op of each property in Ops
+	 * @param OpCounts Number of ops of each property
+	 * @param OutValues Receives the calculated value of each property, must be as large as BaseValues
+	 */
+	static void EvaluateStacks(TArrayView<const float> BaseValues, TArrayView<const FModifierLinearOp> Ops, TArrayView<const int32> OpStarts, TArrayView<const int32> OpCounts, TArrayView<float> OutValues);
+
+	/**
+	 * Evaluates affine forms for many base values: OutValues[i] = BaseValues[i] * Scales[i] + Offsets[i]
+	 * Multiplies and adds are not fused, so every lane matches the scalar expression
+	 * @param BaseValues Base value of each property
+	 * @param Scales Collapsed scale of each property
+	 * @param Offsets Collapsed offset of each property
+	 * @param OutValues Receives the calculated value of each property, must be as large as BaseValues
+	 */
+	static void EvaluateAffine(TArrayView<const float> BaseValues, TArrayView<const float> Scales, TArrayView<const float> Offsets, TArrayView<float> OutValues);
+
+	/**
+	 * Collapses a linear modifier stack into a single affine form of the base value
+	 * The result matches sequential evaluation up to floating point rounding
+	 * @param Ops The ops of the stack, in application order
+	 * @return The collapsed form
+	 */
+	static FModifierAffineForm CollapseLinearOps(TArrayView<const FModifierLinearOp> Ops);
+};
@@ -0,0 +1,37 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Scoped helper that keeps a batch open on a dynamic property or container for its lifetime
+ * Calls BeginBatch on construction and EndBatch on destruction
+ */
+template<typename TargetType>
+struct TDynamicPropertiesBatchScope
+{
+	explicit TDynamicPropertiesBatchScope(TargetType* InTarget)
+		: Target(InTarget)
+	{
+		if (Target)
+		{
+			Target->BeginBatch();
+		}
+	}
+
+	~TDynamicPropertiesBatchScope()
+	{
+		if (Target)
+		{
+			Target->EndBatch();
+		}
+	}
+
+	TDynamicPropertiesBatchScope(const TDynamicPropertiesBatchScope&) = delete;
+	TDynamicPropertiesBatchScope& operator=(const TDynamicPropertiesBatchScope&) = delete;
+
+private:
+	/** The batched property or container */
+	TargetType* Target;
+};
@@ -6,14 +6,75 @@
 #include "Components/ActorComponent.h"
 #include "GameplayTagContainer.h"
 #include "DynamicProperty.h"
+#include "DynamicPropertyStore.h"
+#include "DynamicPropertiesReplication.h"
+#include "DynamicPropertiesReadView.h"
 #include "PropertyValueChangedBinder.h"
 #include "DynamicPropertiesContainer.generated.h"
 
+class USharedModifier;
+class UDynamicPropertiesPreset;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNewPropertyAdded, FGameplayTag, PropertyTag, UDynamicProperty*, Property);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPropertyValueChanged, FGameplayTag, PropertyTag, float, OldValue, float, NewValue);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPropertiesRestored);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPropertiesInitialized);
+
+/**
+ * Net change of a property's value over a frame, delivered by OnPropertyValuesChangedThisFrame
+ */
+USTRUCT(BlueprintType)
+struct DYNAMICPROPERTIES_API FDynamicPropertyCoalescedChange
+{
+	GENERATED_BODY()
+
+	/** The tag of the property that changed */
+	UPROPERTY(BlueprintReadOnly, Category = "Dynamic Properties")
+	FGameplayTag PropertyTag;
+
+	/** Value before the first change of the frame */
+	UPROPERTY(BlueprintReadOnly, Category = "Dynamic Properties")
+	float OldValue = 0.0f;
+
+	/** Value after the last change of the frame */
+	UPROPERTY(BlueprintReadOnly, Category = "Dynamic Properties")
+	float NewValue = 0.0f;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPropertyValuesChangedThisFrame, const TArray<FDynamicPropertyCoalescedChange>&, Changes);
+
+/**
+ * Object counts and memory of one or more containers, see UDynamicPropertiesContainer::AccumulateMemoryStats
+ * Byte counts include the objects themselves and the heap memory they hold
+ */
+struct DYNAMICPROPERTIES_API FDynamicPropertiesMemoryStats
+{
+	int32 NumContainers = 0;
+	int32 NumPropertyObjects = 0;
+	int32 NumCompactProperties = 0;
+
+	/** Distinct modifier objects, a modifier applied to several properties is counted once */
+	int32 NumModifierObjects = 0;
+	int32 NumStructModifiers = 0;
+
+	/** Bindings of the container events, there are no binder objects between properties and their container */
+	int32 NumContainerBindings = 0;
+
+	/** Bindings of the ValueChanged events of property objects */
+	int32 NumPropertyBindings = 0;
+
+	SIZE_T ContainerBytes = 0;
+	SIZE_T PropertyBytes = 0;
+	SIZE_T ModifierBytes = 0;
+
+	SIZE_T GetTotalBytes() const { return ContainerBytes + PropertyBytes + ModifierBytes; }
+
+	FDynamicPropertiesMemoryStats& operator+=(const FDynamicPropertiesMemoryStats& Other);
+};
 
 /**
  * Actor component that manages a collection of dynamic properties identified by gameplay tags
+ * Properties are either UDynamicProperty objects or entries in a compact struct-of-arrays store
  */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class DYNAMICPROPERTIES_API UDynamicPropertiesContainer : public UActorComponent
@@ -23,14 +84,60 @@ class DYNAMICPROPERTIES_API UDynamicPropertiesContainer : public UActorComponent
 public:	
 	UDynamicPropertiesContainer();
 
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	virtual void BeginPlay() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 	/** Map of dynamic properties indexed by gameplay tags */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dynamic Properties")
 	TMap<FGameplayTag, UDynamicProperty*> DynamicProperties;
 
-	/** Helper objects for binding property value changed events */
-	UPROPERTY()
-	TArray<UPropertyValueChangedBinder*> ValueChangedBinders;
+	/** Binders saved by earlier versions, emptied on load */
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Properties notify their container directly."))
+	TArray<UDEPRECATED_PropertyValueChangedBinder*> ValueChangedBinders_DEPRECATED;
+
+	/**
+	 * If true, properties added through AddProperty are kept in compact storage instead of one object per property
+	 * A compact property is turned into a UDynamicProperty object the first time GetProperty is called for it
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dynamic Properties")
+	bool bUseCompactStorage = false;
+
+	/**
+	 * If true, property objects created by this container use lazy evaluation: changes only mark them (and their dependents) dirty,
+	 * and values are recalculated when read or flushed. Compact properties are always evaluated immediately
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dynamic Properties")
+	bool bLazyEvaluation = false;
+
+	/**
+	 * If true, property objects created by this container are lazy and the container is evaluated by the world's
+	 * UDynamicPropertiesSubsystem at the end of the frame, with native modifier stacks evaluated in parallel across containers
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dynamic Properties")
+	bool bEvaluateInWorldSubsystem = false;
+
+	/**
+	 * If true, value changes are also collected over the frame and OnPropertyValuesChangedThisFrame is broadcast once
+	 * at the end of it by the world's UDynamicPropertiesSubsystem, with one entry per property whose value changed
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dynamic Properties")
+	bool bCoalesceValueChanges = false;
+
+	/** Preset the container is initialized from when play begins, see InitializeFromPreset */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dynamic Properties")
+	UDynamicPropertiesPreset* InitialPreset = nullptr;
+
+	/**
+	 * Precision used to replicate the values of specific properties, others are sent at full precision
+	 * Values are replicated when the component is replicated; on clients they come from the server and override local changes
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dynamic Properties|Replication")
+	TMap<FGameplayTag, EDynamicPropertyQuantization> ReplicationQuantization;
 
 public:
 
@@ -38,8 +145,24 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Dynamic Properties")
 	FOnPropertyValueChanged OnPropertyValueChanged;
 
+	/**
+	 * Event fired at the end of a frame in which property values changed, when bCoalesceValueChanges is set
+	 * Each property appears once with its first old and last new value, properties that ended where they started are left out
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Dynamic Properties")
+	FOnPropertyValuesChangedThisFrame OnPropertyValuesChangedThisFrame;
+
+	/** Event fired once after all properties were replaced by LoadSnapshot */
+	UPROPERTY(BlueprintAssignable, Category = "Dynamic Properties")
+	FOnPropertiesRestored OnPropertiesRestored;
+
+	/** Event fired once after InitializeFromPreset added its properties, instead of one value change per property */
+	UPROPERTY(BlueprintAssignable, Category = "Dynamic Properties")
+	FOnPropertiesInitialized OnPropertiesInitialized;
+
 	/**
 	 * Gets a property by its gameplay tag
+	 * A property kept in compact storage is turned into an object by this call
 	 * @param PropertyTag The gameplay tag identifying the property
 	 * @return The dynamic property, or nullptr if not found
 	 */
@@ -55,6 +178,31 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
 	UDynamicProperty* GetOrAddProperty(FGameplayTag PropertyTag, float BaseValue);
 
+	/**
+	 * Adds a property if it doesn't exist, without requiring an object for it
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param BaseValue The base value of the new property
+	 * @return True if the property was added, false if it already existed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	bool AddProperty(FGameplayTag PropertyTag, float BaseValue);
+
+	/**
+	 * Removes a property from the container
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @return True if the property existed and was removed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	bool RemoveProperty(FGameplayTag PropertyTag);
+
+	/**
+	 * Checks whether the container has its own property for a tag
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @return True if the property exists
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Properties")
+	bool HasProperty(FGameplayTag PropertyTag) const;
+
 	/**
 	 * Gets the value of a property, or returns a default value if the property doesn't exist
 	 * @param PropertyTag The gameplay tag identifying the property
@@ -64,6 +212,125 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
 	virtual float GetPropertyValueOrDefault(FGameplayTag PropertyTag, float DefaultValue);
 
+	/**
+	 * Sets the base value of a property and recalculates it
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param NewBaseValue The new base value
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void SetPropertyBaseValue(FGameplayTag PropertyTag, float NewBaseValue);
+
+	/**
+	 * Adds a modifier to a property and recalculates it
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param Modifier The modifier to add
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void AddPropertyModifier(FGameplayTag PropertyTag, UModifier* Modifier);
+
+	/**
+	 * Removes a modifier from a property and recalculates it
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param Modifier The modifier to remove
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void RemovePropertyModifier(FGameplayTag PropertyTag, UModifier* Modifier);
+
+	/**
+	 * Adds a modifier to a property that is removed automatically once its lifetime ends, by the world's UDynamicPropertiesSubsystem
+	 * The property is turned into a property object if it is compact, the expiration removes exactly the modifier added here
+	 * even if the same modifier object is applied to the property more than once
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param Modifier The modifier to add
+	 * @param Duration Lifetime of the modifier, in seconds of world time
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void AddTimedPropertyModifier(FGameplayTag PropertyTag, UModifier* Modifier, float Duration);
+
+	/**
+	 * Applies a shared modifier to a property, which then follows every change of the shared modifier
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param SharedModifier The shared modifier to apply
+	 * @return False if the property doesn't exist
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	bool SubscribeToSharedModifier(FGameplayTag PropertyTag, USharedModifier* SharedModifier);
+
+	/**
+	 * Removes a shared modifier from a property
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param SharedModifier The shared modifier to remove
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void UnsubscribeFromSharedModifier(FGameplayTag PropertyTag, USharedModifier* SharedModifier);
+
+	/**
+	 * Re-reads the priorities and parameters of a property's modifiers and recalculates it
+	 * Call after editing modifiers that are already applied
+	 * @param PropertyTag The gameplay tag identifying the property
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void RefreshPropertyModifiers(FGameplayTag PropertyTag);
+
+	/**
+	 * Checks whether modifiers reading other properties form a cycle
+	 * Properties on a cycle are not recalculated when their inputs change
+	 * @return True if at least one property depends on itself, directly or through others
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Properties")
+	bool HasDependencyCycle();
+
+	/**
+	 * Gets the properties whose modifiers read a property, see UModifier::GetPropertyDependencies
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param OutDependents Array to be filled with the tags of the properties reading it
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void GetDependentProperties(FGameplayTag PropertyTag, TArray<FGameplayTag>& OutDependents);
+
+	/**
+	 * Removes the modifiers added on behalf of a source object from every property, in a single batch
+	 * Modifiers are tied to a source through UDynamicProperty::AddModifier, compact properties never have any
+	 * @param Source The object passed when the modifiers were added
+	 * @return Number of modifiers removed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	int32 RemoveModifiersBySource(const UObject* Source);
+
+	/**
+	 * Broadcasts the value changes collected since the last call now, instead of waiting for the end of the frame
+	 * Outside of a world the changes are only delivered by this call
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void FlushCoalescedValueChanges();
+
+	/**
+	 * Gets the thread-safe read view of this container, creating and publishing it on first use
+	 * Once a view exists, values are published to it by the world's UDynamicPropertiesSubsystem at the end of every frame
+	 * in which they changed; outside of a world only by PublishReadView. Game thread only, the view itself may be used anywhere
+	 * @return The read view
+	 */
+	TSharedRef<FDynamicPropertiesReadView, ESPMode::ThreadSafe> GetReadView();
+
+	/**
+	 * Publishes the current values to the read view now, if any changed since the last publish
+	 */
+	void PublishReadView();
+
+	/**
+	 * Gets the heap memory held by native state, which reflection based memory counting doesn't see
+	 * Counted by Serialize when the archive counts memory
+	 * @return Allocated bytes
+	 */
+	virtual SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Adds the objects and memory of this container, its property objects and their modifiers to running totals
+	 * @param Stats The totals to add to
+	 * @param CountedModifiers Modifiers counted so far, shared modifiers are only counted the first time they are met
+	 */
+	void AccumulateMemoryStats(FDynamicPropertiesMemoryStats& Stats, TSet<const UModifier*>& CountedModifiers) const;
+
 	/**
 	 * Gets all property tags in the container
 	 * @param OutKeys Array to be filled with all property tags
@@ -71,14 +338,133 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
 	void GetPropertiesKeys(TArray<FGameplayTag>& OutKeys);
 
+	/**
+	 * Starts a batch on every property: modifier and base value changes are queued until the matching EndBatch
+	 * Batches can be nested, only the outermost EndBatch applies the queued changes
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void BeginBatch();
+
+	/**
+	 * Ends a batch: every changed property is recalculated once, in update order, and fires its events once
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void EndBatch();
+
+	/**
+	 * Checks whether changes to the properties are currently being batched
+	 * @return True if inside a BeginBatch/EndBatch pair
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Properties")
+	bool IsBatching() const { return BatchDepth > 0; }
+
+	/**
+	 * Recalculates every dirty lazy property now, firing their change events
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void FlushPendingChanges();
+
+	/**
+	 * Re-reads the parameters of every modifier and recalculates every property, e.g. after tuning shared modifiers
+	 * Compact properties are evaluated together with the vectorized batch kernel
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void RecalculateAllProperties();
+
+	/**
+	 * Writes all properties and their modifier stacks to a compact binary snapshot
+	 * @param OutData Filled with the snapshot
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void SaveSnapshot(TArray<uint8>& OutData) const;
+
+	/**
+	 * Replaces all properties with the content of a snapshot, recalculating once
+	 * No per-property events are fired, OnPropertiesRestored is broadcast at the end instead
+	 * @param Data A snapshot written by SaveSnapshot
+	 * @return True if the snapshot was valid and restored
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	bool LoadSnapshot(const TArray<uint8>& Data);
+
+	/**
+	 * Adds the properties of a preset in bulk: storage is reserved once, properties are inserted without per-property events,
+	 * cascade base values are resolved in a single pass and OnPropertiesInitialized is broadcast at the end
+	 * Properties the container already has are left as they are
+	 * @param Preset The preset to add the properties of
+	 * @return Number of properties added
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	int32 InitializeFromPreset(const UDynamicPropertiesPreset* Preset);
+
+	/**
+	 * Gets a handle to a property in compact storage, or adds it there if it doesn't exist
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param BaseValue The base value to use if creating a new property
+	 * @return Handle to the property, or an invalid handle if the tag is already used by a property object
+	 */
+	FDynamicPropertyHandle GetOrAddPropertyHandle(FGameplayTag PropertyTag, float BaseValue);
+
+	/**
+	 * Finds the handle of a property in compact storage
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @return Handle to the property, or an invalid handle if it isn't in compact storage
+	 */
+	FDynamicPropertyHandle FindPropertyHandle(FGameplayTag PropertyTag) const { return CompactProperties.Find(PropertyTag); }
+
+	/**
+	 * Gets the value of a property in compact storage
+	 * The ByHandle functions also reach a property that has since been turned into a property object, through the handle's tag
+	 * @param Handle Handle to the property
+	 * @param DefaultValue The value to return if the property no longer exists
+	 * @return The property's value, or the default value
+	 */
+	float GetPropertyValueByHandle(const FDynamicPropertyHandle& Handle, float DefaultValue = 0.0f) const;
+
+	/**
+	 * Gets the base value of a property in compact storage
+	 * @param Handle Handle to the property
+	 * @param DefaultValue The value to return if the property no longer exists
+	 * @return The property's base value, or the default value
+	 */
+	float GetPropertyBaseValueByHandle(const FDynamicPropertyHandle& Handle, float DefaultValue = 0.0f) const;
+
+	/**
+	 * Sets the base value of a property in compact storage and recalculates it
+	 * @param Handle Handle to the property
+	 * @param NewBaseValue The new base value
+	 */
+	void SetPropertyBaseValueByHandle(const FDynamicPropertyHandle& Handle, float NewBaseValue);
+
+	/**
+	 * Adds a modifier to a property in compact storage and recalculates it
+	 * @param Handle Handle to the property
+	 * @param Modifier The modifier to add
+	 */
+	void AddPropertyModifierByHandle(const FDynamicPropertyHandle& Handle, UModifier* Modifier);
+
+	/**
+	 * Removes a modifier from a property in compact storage and recalculates it
+	 * @param Handle Handle to the property
+	 * @param Modifier The modifier to remove
+	 */
+	void RemovePropertyModifierByHandle(const FDynamicPropertyHandle& Handle, UModifier* Modifier);
+
 protected:
 	/**
 	 * Called when a new property is added - override in derived classes for custom behavior
 	 * @param PropertyTag The tag of the newly added property
-	 * @param Property The newly added property
+	 * @param Property The newly added property, or nullptr if it is kept in compact storage
 	 */
 	virtual void OnPropertyAddedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property);
 
+	/**
+	 * Called after a property has been removed - override in derived classes for custom behavior
+	 * @param PropertyTag The tag of the removed property
+	 * @param Property The removed property, or nullptr if it was kept in compact storage
+	 */
+	virtual void OnPropertyRemovedInternal(FGameplayTag PropertyTag, UDynamicProperty* Property);
+
 	/**
 	 * Called when a property's value changes - override in derived classes for custom behavior
 	 * @param PropertyTag The tag of the property that changed
@@ -87,21 +473,270 @@ protected:
 	 */
 	virtual void OnPropertyValueChangedInternal(FGameplayTag PropertyTag, float OldValue, float NewValue);
 
+	/**
+	 * Gets the property tags in the order their pending changes should be applied - override when properties depend on each other
+	 * @param OutTags Array to be filled with all property tags
+	 */
+	virtual void GetPropertiesInUpdateOrder(TArray<FGameplayTag>& OutTags) const;
+
+	/**
+	 * Called when a lazy property becomes dirty - override to mark properties that depend on it dirty as well
+	 * @param PropertyTag The tag of the property that became dirty
+	 */
+	virtual void OnPropertyDirtyInternal(FGameplayTag PropertyTag);
+
+	/**
+	 * Called before a dirty property is recalculated - override to bring the values it is derived from up to date
+	 * @param PropertyTag The tag of the property about to be recalculated
+	 */
+	virtual void FlushPropertyDependencies(FGameplayTag PropertyTag);
+
+	/**
+	 * Marks a lazy property object dirty, eager and compact properties are left untouched
+	 * @param PropertyTag The gameplay tag identifying the property
+	 */
+	void MarkPropertyDirty(FGameplayTag PropertyTag);
+
+	/**
+	 * Sets the base value of a property and recalculates it without firing any event, deferring while batching or lazy
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param NewBaseValue The new base value
+	 * @param OutOldValue Set to the value before recalculation
+	 * @param OutNewValue Set to the value after recalculation
+	 * @return True if the value was recalculated now and changed, the caller is then responsible for reporting it
+	 */
+	bool SetPropertyBaseValueSilently(FGameplayTag PropertyTag, float NewBaseValue, float& OutOldValue, float& OutNewValue);
+
+	/**
+	 * Broadcasts the ValueChanged event of a property object, for changes applied with SetPropertyBaseValueSilently
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param OldValue The previous value
+	 * @param NewValue The new value
+	 */
+	void BroadcastPropertyValueChanged(FGameplayTag PropertyTag, float OldValue, float NewValue);
+
+	/**
+	 * Precomputes the values of dirty properties with native modifier stacks, ahead of FlushPendingChanges
+	 * Runs on a worker thread: must only read this container and write to its own properties
+	 * @return Number of properties precomputed
+	 */
+	virtual int32 PrecomputePendingValues();
+
+	/**
+	 * Called after all properties were replaced by a snapshot - override to rebuild state derived from the set of properties
+	 * Overrides call the base implementation last, it calculates the restored values in update order before OnPropertiesRestored
+	 */
+	virtual void OnPropertiesRestoredInternal();
+
+	/**
+	 * Called after InitializeFromPreset inserted its properties - override to update state derived from the set of properties
+	 * Overrides call the base implementation last, it settles added lazy properties silently before OnPropertiesInitialized
+	 * @param AddedTags The added properties, parents before children
+	 */
+	virtual void OnPropertiesInitializedInternal(const TArray<FGameplayTag>& AddedTags);
+
+	/**
+	 * Checks whether property objects created by this container defer their recalculation
+	 * @return True if lazy evaluation is enabled directly or through the world subsystem
+	 */
+	bool UsesLazyEvaluation() const { return bLazyEvaluation || bEvaluateInWorldSubsystem; }
+
+	/**
+	 * Checks whether value changes are sent to clients
+	 * @return True if the component is replicated and has authority
+	 */
+	bool ShouldReplicateValues() const;
+
+	/**
+	 * Checks whether the change being reported comes from the server - derived classes should not derive other values from it,
+	 * since those are replicated as well
+	 * @return True while replicated values are being applied
+	 */
+	bool IsApplyingReplicatedValues() const { return bApplyingReplicatedValues; }
+
+	/**
+	 * Gets the value of the container's own property for a tag, whichever storage it lives in
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param OutValue Set to the property's value if found
+	 * @return True if the property exists
+	 */
+	bool FindPropertyValue(FGameplayTag PropertyTag, float& OutValue) const;
+
+	/**
+	 * Gets a property object without turning compact properties into objects
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @return The property object, or nullptr if there is none
+	 */
+	UDynamicProperty* FindPropertyObject(FGameplayTag PropertyTag) const;
+
 private:
+	friend class UDynamicProperty;
+	friend class UDynamicPropertiesSubsystem;
+	friend struct FDynamicPropertyReplicatedItem;
+	friend struct FDynamicPropertiesSnapshot;
+
+	/** Values of all properties, delta replicated to clients */
+	UPROPERTY(Replicated)
+	FDynamicPropertiesReplicatedValues ReplicatedValues;
+
+	/** Whether the container is queued in the world subsystem */
+	bool bRegisteredWithSubsystem = false;
+
+	/** Whether the container is queued in the world subsystem to broadcast its coalesced changes */
+	bool bRegisteredForCoalescedChanges = false;
+
+	/** Whether the container is queued in the world subsystem to publish its read view */
+	bool bRegisteredForReadViewPublish = false;
+
+	/** Whether values changed since they were last published to ReadView */
+	bool bReadViewDirty = false;
+
+	/** Values published for other threads, only created on request */
+	TSharedPtr<FDynamicPropertiesReadView, ESPMode::ThreadSafe> ReadView;
+
+	/** Whether values received from the server are being applied */
+	bool bApplyingReplicatedValues = false;
+
+	/** Nesting depth of open batches */
+	int32 BatchDepth = 0;
+
+	/** Properties kept in compact storage */
+	FDynamicPropertyStore CompactProperties;
+
+	/** Lazy properties that became dirty since the last flush */
+	TSet<FGameplayTag> DirtyPropertyTags;
+
+	/** Properties read by the modifiers of each property, for the properties that read any */
+	TMap<FGameplayTag, TArray<FGameplayTag>> PropertyInputs;
+
+	/** Properties whose modifiers read each property, derived from PropertyInputs */
+	TMap<FGameplayTag, TArray<FGameplayTag>> PropertyDependents;
+
+	/** Topological rank in the dependency graph, properties rank above every property they read */
+	TMap<FGameplayTag, int32> DependencyRanks;
+
+	/** Properties on a dependency cycle, left out of dependency updates */
+	TSet<FGameplayTag> CyclicPropertyTags;
+
+	/** Dependents waiting to be recalculated with their rank, as a min-heap on rank */
+	TArray<TPair<int32, FGameplayTag>> PendingDependents;
+
+	/** Tags in PendingDependents */
+	TSet<FGameplayTag> QueuedDependents;
+
+	/** Whether PropertyDependents, DependencyRanks and CyclicPropertyTags need to be rebuilt from PropertyInputs */
+	bool bDependencyOrderDirty = false;
+
+	/** Whether dependents are being recalculated, changes made meanwhile only queue their own dependents */
+	bool bUpdatingDependents = false;
+
+	/** Changes collected since the last coalesced broadcast, one per property */
+	TArray<FDynamicPropertyCoalescedChange> CoalescedChanges;
+
+	/** Index of each property's entry in CoalescedChanges */
+	TMap<FGameplayTag, int32> CoalescedChangeIndices;
+
+	/**
+	 * Folds a value change into the pending coalesced changes and queues the broadcast
+	 * @param PropertyTag The tag of the property that changed
+	 * @param OldValue The previous value
+	 * @param NewValue The new value
+	 */
+	void CoalesceValueChange(FGameplayTag PropertyTag, float OldValue, float NewValue);
+
+	/**
+	 * Marks the read view out of date and queues its publish, if there is a read view
+	 */
+	void MarkReadViewDirty();
+
 	/**
-	 * Binds the value changed handler for a specific property
-	 * @param PropertyTag The tag of the property to bind
-	 * @param Property The property to bind to
+	 * Called natively by an owned property object when its modifiers change
+	 * @param PropertyTag The tag of the property
 	 */
-	void BindPropertyValueChanged(FGameplayTag PropertyTag, UDynamicProperty* Property);
+	void HandlePropertyModifiersChanged(FGameplayTag PropertyTag) { UpdatePropertyInputs(PropertyTag); }
 
 	/**
-	 * Handler called when a binder's value changes
+	 * Called for each modifier taken off a property, by an owned property object or by this container
+	 * Ends one subscription of the property if the modifier is a shared modifier
+	 * @param PropertyTag The tag of the property
+	 * @param Modifier The removed modifier
+	 */
+	void HandlePropertyModifierRemoved(FGameplayTag PropertyTag, UModifier* Modifier);
+
+	/**
+	 * Re-reads the properties a property's modifiers depend on, marking the dependency order dirty if they changed
+	 * @param PropertyTag The tag of the property
+	 */
+	void UpdatePropertyInputs(FGameplayTag PropertyTag);
+
+	/**
+	 * Re-reads the dependencies of every property
+	 */
+	void RebuildPropertyInputs();
+
+	/**
+	 * Rebuilds the dependents, topological ranks and cycles from the property inputs if they changed
+	 */
+	void EnsureDependencyOrder();
+
+	/**
+	 * Calculates the values of restored properties without notifying, each after the properties its modifiers read
+	 */
+	void RecalculateRestoredProperties();
+
+	/**
+	 * Recalculates every property downstream of a changed property, once each and in topological order
+	 * @param PropertyTag The tag of the property that changed
+	 */
+	void UpdateDependentProperties(FGameplayTag PropertyTag);
+
+	/**
+	 * Recalculates a compact property after a change and notifies, or defers it while batching
+	 * @param Index Index of the property in compact storage
+	 */
+	void ApplyCompactPropertyChange(int32 Index);
+
+	/**
+	 * Moves a property from compact storage into a new property object
+	 * @param PropertyTag The tag of the compact property
+	 * @return The new property object, or nullptr if the tag isn't in compact storage
+	 */
+	UDynamicProperty* PromoteCompactProperty(FGameplayTag PropertyTag);
+
+	/**
+	 * Called natively by an owned property object when its value changes
 	 * @param PropertyTag The tag of the property that changed
 	 * @param OldValue The previous value
 	 * @param NewValue The new value
 	 */
-	UFUNCTION()
-	void HandleBinderValueChanged(FGameplayTag PropertyTag, float OldValue, float NewValue);
+	void HandlePropertyValueChanged(FGameplayTag PropertyTag, float OldValue, float NewValue);
+
+	/**
+	 * Called natively by an owned lazy property object when it becomes dirty
+	 * @param PropertyTag The tag of the property that became dirty
+	 */
+	void HandlePropertyDirty(FGameplayTag PropertyTag);
+
+	/**
+	 * Sends the value of a property to clients, with the precision configured for its tag
+	 * @param PropertyTag The tag of the property
+	 * @param Value The value to send
+	 */
+	void ReplicatePropertyValue(FGameplayTag PropertyTag, float Value);
+
+	/**
+	 * Applies a value received from the server, adding the property if needed
+	 * @param PropertyTag The tag of the property
+	 * @param Value The replicated value
+	 */
+	void HandleReplicatedValue(FGameplayTag PropertyTag, float Value);
+
+	/**
+	 * Removes a property the server stopped replicating
+	 * @param PropertyTag The tag of the property
+	 */
+	void HandleReplicatedRemove(FGameplayTag PropertyTag);
 };
 
+/** Scoped batch of changes to all properties of a container */
+using FDynamicPropertiesContainerBatchScope = TDynamicPropertiesBatchScope<UDynamicPropertiesContainer>;
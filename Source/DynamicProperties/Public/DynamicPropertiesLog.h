@@ -0,0 +1,7 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DYNAMICPROPERTIES_API DECLARE_LOG_CATEGORY_EXTERN(LogDynamicProperties, Log, All);
@@ -0,0 +1,57 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "GameplayTagContainer.h"
+#include "DynamicPropertiesPreset.generated.h"
+
+/**
+ * A property created by a preset
+ */
+USTRUCT(BlueprintType)
+struct DYNAMICPROPERTIES_API FDynamicPropertyPresetEntry
+{
+	GENERATED_BODY()
+
+	/** The gameplay tag identifying the property */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dynamic Properties")
+	FGameplayTag PropertyTag;
+
+	/** The base value of the property, replaced by the parent's value in cascade containers */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dynamic Properties")
+	float BaseValue = 0.0f;
+};
+
+/**
+ * Set of properties added to a container in one go by UDynamicPropertiesContainer::InitializeFromPreset
+ */
+UCLASS(BlueprintType)
+class DYNAMICPROPERTIES_API UDynamicPropertiesPreset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/**
+	 * Gets the properties of the preset, parents before children, without invalid or duplicate tags
+	 * @return The entries, sorted on first use
+	 */
+	const TArray<FDynamicPropertyPresetEntry>& GetPropertiesInDepthOrder() const;
+
+protected:
+	/** The properties to add */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dynamic Properties", meta = (TitleProperty = "PropertyTag"))
+	TArray<FDynamicPropertyPresetEntry> Properties;
+
+private:
+	/** Properties sorted by tag depth, built once per asset instead of once per initialized container */
+	mutable TArray<FDynamicPropertyPresetEntry> SortedProperties;
+
+	/** Whether SortedProperties matches Properties */
+	mutable bool bSortedPropertiesValid = false;
+};
@@ -0,0 +1,152 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include <atomic>
+
+class FDynamicPropertiesReadView;
+
+/**
+ * Immutable copy of a container's property values, published by the game thread for other threads
+ */
+class DYNAMICPROPERTIES_API FDynamicPropertiesValueSnapshot
+{
+public:
+	/**
+	 * Gets the value a property had when the snapshot was published
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param OutValue Set to the property's value if found
+	 * @return True if the property existed
+	 */
+	bool FindValue(FGameplayTag PropertyTag, float& OutValue) const
+	{
+		const float* Value = Values.Find(PropertyTag);
+		if (Value)
+		{
+			OutValue = *Value;
+		}
+		return Value != nullptr;
+	}
+
+	/**
+	 * Gets the value a property had when the snapshot was published
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param DefaultValue Returned if the property didn't exist
+	 * @return The property's value or DefaultValue
+	 */
+	float GetValueOrDefault(FGameplayTag PropertyTag, float DefaultValue) const
+	{
+		const float* Value = Values.Find(PropertyTag);
+		return Value ? *Value : DefaultValue;
+	}
+
+	/** All published values */
+	const TMap<FGameplayTag, float>& GetValues() const { return Values; }
+
+	/** Publish counter of the snapshot, increasing with every publish of the same view */
+	uint64 GetVersion() const { return Version; }
+
+private:
+	friend class FDynamicPropertiesReadView;
+	friend class FDynamicPropertiesValueSnapshotRef;
+
+	TMap<FGameplayTag, float> Values;
+
+	uint64 Version = 0;
+
+	/** Number of live references, the snapshot is only freed once it is retired and this is zero */
+	mutable std::atomic<int32> NumReferences{ 0 };
+};
+
+/**
+ * Reference to a published snapshot, keeps it and its view alive while held
+ * May be acquired, copied and released on any thread
+ */
+class DYNAMICPROPERTIES_API FDynamicPropertiesValueSnapshotRef
+{
+public:
+	FDynamicPropertiesValueSnapshotRef() = default;
+	FDynamicPropertiesValueSnapshotRef(const FDynamicPropertiesValueSnapshotRef& Other);
+	FDynamicPropertiesValueSnapshotRef& operator=(const FDynamicPropertiesValueSnapshotRef& Other);
+	~FDynamicPropertiesValueSnapshotRef();
+
+	/** Whether a snapshot has been published at all */
+	bool IsValid() const { return Snapshot != nullptr; }
+
+	const FDynamicPropertiesValueSnapshot* operator->() const { return Snapshot; }
+	const FDynamicPropertiesValueSnapshot& operator*() const { return *Snapshot; }
+
+private:
+	friend class FDynamicPropertiesReadView;
+
+	FDynamicPropertiesValueSnapshotRef(TSharedPtr<const FDynamicPropertiesReadView, ESPMode::ThreadSafe> InView, const FDynamicPropertiesValueSnapshot* InSnapshot);
+
+	void Release();
+
+	/** Keeps the view, which owns the snapshot memory, alive */
+	TSharedPtr<const FDynamicPropertiesReadView, ESPMode::ThreadSafe> View;
+
+	const FDynamicPropertiesValueSnapshot* Snapshot = nullptr;
+};
+
+/**
+ * Lock-free read path to the property values of a container
+ * The game thread publishes a new snapshot after values changed, any thread reads the latest one without touching UObjects
+ * Readers see values as of the last publish, at most a frame old when the container is in a world
+ */
+class DYNAMICPROPERTIES_API FDynamicPropertiesReadView : public TSharedFromThis<FDynamicPropertiesReadView, ESPMode::ThreadSafe>
+{
+public:
+	FDynamicPropertiesReadView() = default;
+	~FDynamicPropertiesReadView();
+
+	FDynamicPropertiesReadView(const FDynamicPropertiesReadView&) = delete;
+	FDynamicPropertiesReadView& operator=(const FDynamicPropertiesReadView&) = delete;
+
+	/**
+	 * Gets the latest published snapshot, callable from any thread
+	 * Hold on to the reference to read several values consistently
+	 * @return Reference to the latest snapshot, invalid if nothing was published yet
+	 */
+	FDynamicPropertiesValueSnapshotRef Acquire() const;
+
+	/**
+	 * Gets a value from the latest published snapshot, callable from any thread
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param DefaultValue Returned if the property didn't exist or nothing was published yet
+	 * @return The property's published value or DefaultValue
+	 */
+	float GetValueOrDefault(FGameplayTag PropertyTag, float DefaultValue) const;
+
+	/**
+	 * Publishes new values and retires the previous snapshot, game thread only
+	 * @param Values The values of all properties
+	 */
+	void Publish(TMap<FGameplayTag, float>&& Values);
+
+	/**
+	 * Frees retired snapshots no reader references anymore, game thread only
+	 */
+	void CollectRetiredSnapshots();
+
+	/**
+	 * Gets the memory held by the current and retired snapshots, game thread only
+	 * @return Allocated bytes, including the view itself
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** The latest published snapshot */
+	std::atomic<FDynamicPropertiesValueSnapshot*> Current{ nullptr };
+
+	/** Number of Acquire calls between reading Current and referencing it */
+	mutable std::atomic<int32> NumAcquiring{ 0 };
+
+	/** Snapshots replaced by a newer one, waiting for their readers to release them */
+	TArray<FDynamicPropertiesValueSnapshot*> Retired;
+
+	/** Version given to the next published snapshot */
+	uint64 NextVersion = 1;
+};
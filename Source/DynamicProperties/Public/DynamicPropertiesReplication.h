@@ -0,0 +1,137 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "DynamicPropertiesReplication.generated.h"
+
+class UDynamicPropertiesContainer;
+
+/**
+ * Precision used to send a property value over the network
+ */
+UENUM(BlueprintType)
+enum class EDynamicPropertyQuantization : uint8
+{
+	/** Full float precision */
+	None,
+
+	/** Rounded to 0.01 */
+	Hundredths,
+
+	/** Rounded to 0.1 */
+	Tenths,
+
+	/** Rounded to whole numbers */
+	Integer,
+};
+
+/**
+ * Replicated value of one property
+ * Serialized as the tag's network index, the quantization mode and the value, packed
+ */
+USTRUCT()
+struct DYNAMICPROPERTIES_API FDynamicPropertyReplicatedItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** The property the value belongs to */
+	UPROPERTY()
+	FGameplayTag PropertyTag;
+
+	/** The current value of the property */
+	UPROPERTY()
+	float Value = 0.0f;
+
+	/** Precision used to send Value */
+	UPROPERTY()
+	EDynamicPropertyQuantization Quantization = EDynamicPropertyQuantization::None;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	void PostReplicatedAdd(const struct FDynamicPropertiesReplicatedValues& InArraySerializer);
+	void PostReplicatedChange(const struct FDynamicPropertiesReplicatedValues& InArraySerializer);
+	void PreReplicatedRemove(const struct FDynamicPropertiesReplicatedValues& InArraySerializer);
+
+	/**
+	 * Rounds a value the way it is sent over the network
+	 * Values too large for the quantization, and non-finite ones, are sent and returned unchanged
+	 * @param InValue The value to round
+	 * @param InQuantization The precision to round to
+	 * @return The value the receiving side will see
+	 */
+	static float Quantize(float InValue, EDynamicPropertyQuantization InQuantization);
+};
+
+template<>
+struct TStructOpsTypeTraits<FDynamicPropertyReplicatedItem> : public TStructOpsTypeTraitsBase2<FDynamicPropertyReplicatedItem>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * Delta replicated values of a container's properties, only changed items are sent
+ */
+USTRUCT()
+struct DYNAMICPROPERTIES_API FDynamicPropertiesReplicatedValues : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	/** Container receiving replicated values */
+	UDynamicPropertiesContainer* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FDynamicPropertyReplicatedItem, FDynamicPropertiesReplicatedValues>(Items, DeltaParms, *this);
+	}
+
+	/**
+	 * Sets the replicated value of a property, marking it dirty only if the value seen by clients changes
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @param Value The new value
+	 * @param Quantization Precision used to send the value
+	 * @return True if the item was marked dirty
+	 */
+	bool SetValue(FGameplayTag PropertyTag, float Value, EDynamicPropertyQuantization Quantization);
+
+	/**
+	 * Stops replicating a property
+	 * @param PropertyTag The gameplay tag identifying the property
+	 * @return True if the property was replicated and removed
+	 */
+	bool RemoveValue(FGameplayTag PropertyTag);
+
+	/** Stops replicating every property */
+	void Reset();
+
+	/**
+	 * Gets the heap memory held by the tag index, Items is counted through reflection
+	 * @return Allocated bytes
+	 */
+	SIZE_T GetAllocatedSize() const { return ItemIndices.GetAllocatedSize(); }
+
+	/** Values of all replicated properties */
+	const TArray<FDynamicPropertyReplicatedItem>& GetItems() const { return Items; }
+
+private:
+	/** Values of all replicated properties */
+	UPROPERTY()
+	TArray<FDynamicPropertyReplicatedItem> Items;
+
+	/** Maps tags to indices in Items, on the authority only */
+	TMap<FGameplayTag, int32> ItemIndices;
+};
+
+template<>
+struct TStructOpsTypeTraits<FDynamicPropertiesReplicatedValues> : public TStructOpsTypeTraitsBase2<FDynamicPropertiesReplicatedValues>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
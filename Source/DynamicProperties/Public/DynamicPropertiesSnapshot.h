@@ -0,0 +1,49 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDynamicPropertiesContainer;
+
+/**
+ * Versioned binary snapshot of a container's properties and modifier stacks
+ *
+ * Layout (version 3):
+ *  - magic and version
+ *  - tag table: tag names, referenced by index from properties
+ *  - type table: modifier class and struct paths, referenced by index from modifiers
+ *  - modifier objects: type index and tagged property payload, shared by index between properties
+ *    (shared modifiers as a reference type index and their object path, version 2)
+ *  - properties: tag index, storage, base value, modifier object indices and struct modifiers
+ *    (linear struct modifiers as their linear op, others as type index and payload)
+ *  - per applied modifier: source object path and remaining lifetime (version 3)
+ *
+ * Values are not stored, they are recalculated on load once every property is restored, in update order.
+ * Timed modifiers expire after their remaining lifetime, if the container is in a world. Modifiers keep their source
+ * object if it can still be found, so RemoveModifiersBySource still reaches them. Modifier handles are not preserved.
+ * Modifier objects are restored as copies. Object references in their parameters are saved as paths and only resolve to
+ * objects that can still be found or loaded. Shared modifiers are not copied: properties subscribe to the same shared
+ * modifier again, and drop it if it no longer exists.
+ */
+struct DYNAMICPROPERTIES_API FDynamicPropertiesSnapshot
+{
+	/** Current format version */
+	static constexpr uint32 Version = 3;
+
+	/**
+	 * Writes the properties of a container
+	 * @param Container The container to save
+	 * @param OutData Filled with the snapshot
+	 */
+	static void Save(const UDynamicPropertiesContainer& Container, TArray<uint8>& OutData);
+
+	/**
+	 * Replaces the properties of a container with a snapshot, in one pass with a single recalculation
+	 * Per-property events are not fired, the container broadcasts OnPropertiesRestored once at the end
+	 * @param Container The container to restore
+	 * @param Data The snapshot
+	 * @return False if the snapshot is invalid or the container is batching, the container is then left untouched
+	 */
+	static bool Load(UDynamicPropertiesContainer& Container, const TArray<uint8>& Data);
+};
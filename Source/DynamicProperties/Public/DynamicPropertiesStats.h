@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "GameplayTagContainer.h"
+
+/** Instrumentation of recalculations, broadcasts and cascades, compiled out in shipping unless defined otherwise */
+#ifndef DYNAMIC_PROPERTIES_STATS
+#define DYNAMIC_PROPERTIES_STATS !UE_BUILD_SHIPPING
+#endif
+
+#if DYNAMIC_PROPERTIES_STATS
+
+DECLARE_STATS_GROUP(TEXT("DynamicProperties"), STATGROUP_DynamicProperties, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Recalculate"), STAT_DynamicProperties_Recalculate, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Broadcast ValueChanged"), STAT_DynamicProperties_Broadcast, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cascade Update"), STAT_DynamicProperties_CascadeUpdate, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cascade Update Order"), STAT_DynamicProperties_CascadeUpdateOrder, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("End Batch"), STAT_DynamicProperties_EndBatch, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flush Pending Changes"), STAT_DynamicProperties_Flush, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Recalculate All (Batch Kernel)"), STAT_DynamicProperties_RecalculateAll, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Subsystem Evaluate"), STAT_DynamicProperties_SubsystemEvaluate, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Subsystem Expire Modifiers"), STAT_DynamicProperties_ExpireModifiers, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Publish Read View"), STAT_DynamicProperties_PublishReadView, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Recalculations"), STAT_DynamicProperties_Recalculations, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Broadcasts"), STAT_DynamicProperties_Broadcasts, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cascade Nodes Visited"), STAT_DynamicProperties_CascadeNodesVisited, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Modifiers Evaluated"), STAT_DynamicProperties_ModifiersEvaluated, STATGROUP_DynamicProperties, DYNAMICPROPERTIES_API);
+
+/**
+ * Counters tracked per container and per tag for the DynamicProperties.DumpHotspots command
+ */
+enum class EDynamicPropertiesCounter : uint8
+{
+	Recalculations,
+	Broadcasts,
+	CascadeNodesVisited,
+	ModifiersEvaluated,
+	Num
+};
+
+/**
+ * Collects per-container and per-tag counters while DynamicProperties.TrackHotspots is enabled
+ */
+struct DYNAMICPROPERTIES_API FDynamicPropertiesStats
+{
+	/**
+	 * Adds to a counter of a container and a tag, ignored unless hotspot tracking is enabled and called on the game thread
+	 * @param Counter The counter to add to
+	 * @param Container The container the work was done for, may be null
+	 * @param PropertyTag The property the work was done for, may be empty
+	 * @param Amount The amount to add
+	 */
+	static void Record(EDynamicPropertiesCounter Counter, const UObject* Container, FGameplayTag PropertyTag, uint32 Amount = 1);
+};
+
+/** Times a scope with a cycle counter and a CPU trace event */
+#define DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+
+/** Adds to a per-frame counter and to the hotspot counters of a container and tag */
+#define DYNAMIC_PROPERTIES_COUNT(Counter, Container, PropertyTag, Amount) \
+	INC_DWORD_STAT_BY(STAT_DynamicProperties_##Counter, Amount); \
+	FDynamicPropertiesStats::Record(EDynamicPropertiesCounter::Counter, Container, PropertyTag, Amount)
+
+#else
+
+#define DYNAMIC_PROPERTIES_SCOPE_CYCLE_COUNTER(Stat)
+#define DYNAMIC_PROPERTIES_COUNT(Counter, Container, PropertyTag, Amount)
+
+#endif
@@ -0,0 +1,154 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameplayTagContainer.h"
+#include "ModifierHandle.h"
+#include "DynamicPropertiesSubsystem.generated.h"
+
+class UDynamicPropertiesContainer;
+class UDynamicProperty;
+class UModifier;
+
+/**
+ * A modifier scheduled for removal by the world subsystem
+ */
+struct FDynamicPropertiesModifierExpiration
+{
+	/** World time at which the modifier is removed */
+	double ExpirationTime = 0.0;
+
+	/** Container of the property, removals in the same container are batched together */
+	TWeakObjectPtr<UDynamicPropertiesContainer> Container;
+
+	/** Tag of the property in Container */
+	FGameplayTag PropertyTag;
+
+	/** The property object the modifier was added to, if it was added through the property */
+	TWeakObjectPtr<UDynamicProperty> Property;
+
+	/** The modifier object to remove, if any */
+	TWeakObjectPtr<UModifier> Modifier;
+
+	/** Handle of the modifier in Property, if it was added through the property */
+	FModifierHandle Handle;
+};
+
+/**
+ * Timings and counts of the last evaluation of dirty containers
+ */
+USTRUCT(BlueprintType)
+struct DYNAMICPROPERTIES_API FDynamicPropertiesEvaluationStats
+{
+	GENERATED_BODY()
+
+	/** Number of containers evaluated */
+	UPROPERTY(BlueprintReadOnly, Category = "Dynamic Properties")
+	int32 NumContainers = 0;
+
+	/** Number of property values precomputed on worker threads */
+	UPROPERTY(BlueprintReadOnly, Category = "Dynamic Properties")
+	int32 NumPrecomputedProperties = 0;
+
+	/** Time spent evaluating native modifier stacks in parallel, in seconds */
+	UPROPERTY(BlueprintReadOnly, Category = "Dynamic Properties")
+	float ParallelEvaluationSeconds = 0.0f;
+
+	/** Time spent on the game thread applying values, running Blueprint modifiers and broadcasting events, in seconds */
+	UPROPERTY(BlueprintReadOnly, Category = "Dynamic Properties")
+	float GameThreadCommitSeconds = 0.0f;
+};
+
+/**
+ * World subsystem that evaluates containers deferred to it once per frame
+ * Native modifier stacks of all dirty containers are evaluated in parallel, then values are committed
+ * and events broadcast on the game thread
+ */
+UCLASS()
+class DYNAMICPROPERTIES_API UDynamicPropertiesSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Queues a container for evaluation at the end of the frame
+	 * @param Container The container with pending changes
+	 */
+	void RegisterDirtyContainer(UDynamicPropertiesContainer* Container);
+
+	/**
+	 * Queues a container to broadcast its coalesced value changes at the end of the frame
+	 * @param Container The container with collected changes
+	 */
+	void RegisterCoalescingContainer(UDynamicPropertiesContainer* Container);
+
+	/**
+	 * Broadcasts the coalesced value changes of all queued containers
+	 */
+	void FlushCoalescedValueChanges();
+
+	/**
+	 * Queues a container to publish its read view at the end of the frame
+	 * @param Container The container whose values changed
+	 */
+	void RegisterPublishingContainer(UDynamicPropertiesContainer* Container);
+
+	/**
+	 * Publishes the read views of all queued containers
+	 */
+	void PublishReadViews();
+
+	/**
+	 * Evaluates all queued containers now instead of waiting for the end of the frame
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Properties")
+	void EvaluateDirtyContainers();
+
+	/**
+	 * Schedules a modifier for removal
+	 * Modifiers expiring in the same frame are removed together, with one recalculation per affected property
+	 * @param Expiration The modifier to remove, ExpirationTime is ignored
+	 * @param Duration Time from now until the modifier is removed, in seconds
+	 */
+	void ScheduleModifierExpiration(const FDynamicPropertiesModifierExpiration& Expiration, float Duration);
+
+	/**
+	 * Removes every modifier whose lifetime has ended
+	 */
+	void ExpireModifiers();
+
+	/**
+	 * Gets the remaining lifetimes of the modifiers scheduled for removal from the properties of a container
+	 * @param Container The container
+	 * @param OutRemainingDurations Filled with the time left in seconds, by property object and modifier handle
+	 */
+	void GetRemainingModifierDurations(const UDynamicPropertiesContainer* Container, TMap<TPair<const UDynamicProperty*, FModifierHandle>, float>& OutRemainingDurations) const;
+
+	/**
+	 * Gets the timings and counts of the last evaluation
+	 * @return The stats of the last evaluation that had work to do
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Properties")
+	FDynamicPropertiesEvaluationStats GetLastEvaluationStats() const { return LastEvaluationStats; }
+
+private:
+	/** Containers with pending changes, in registration order */
+	TArray<TWeakObjectPtr<UDynamicPropertiesContainer>> DirtyContainers;
+
+	/** Containers with coalesced value changes to broadcast, in registration order */
+	TArray<TWeakObjectPtr<UDynamicPropertiesContainer>> CoalescingContainers;
+
+	/** Containers with values to publish to their read view, in registration order */
+	TArray<TWeakObjectPtr<UDynamicPropertiesContainer>> PublishingContainers;
+
+	/** Scheduled modifier removals, as a min-heap on ExpirationTime */
+	TArray<FDynamicPropertiesModifierExpiration> ExpirationHeap;
+
+	/** Stats of the last evaluation that had work to do */
+	FDynamicPropertiesEvaluationStats LastEvaluationStats;
+};
@@ -4,11 +4,78 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "GameplayTagContainer.h"
+#include "InstancedStruct.h"
+#include "UObject/ObjectKey.h"
 #include "Modifier.h"
+#include "ModifierHandle.h"
+#include "DynamicPropertyModifier.h"
+#include "DynamicPropertiesBatchScope.h"
 #include "DynamicProperty.generated.h"
 
+class UDynamicPropertiesContainer;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnValueChanged, float, OldValue, float, NewValue);
 
+/**
+ * Ordering key of a modifier: priority first, then the order modifiers were added in
+ */
+struct FDynamicPropertyModifierOrderKey
+{
+	/** Priority of the modifier when it was added or last refreshed */
+	int32 Priority = 0;
+
+	/** Increasing counter, keeps modifiers of equal priority in the order they were added */
+	uint32 Sequence = 0;
+
+	/** Handle slot of the modifier, not part of the ordering */
+	int32 Slot = INDEX_NONE;
+
+	bool operator<(const FDynamicPropertyModifierOrderKey& Other) const
+	{
+		return Priority < Other.Priority || (Priority == Other.Priority && Sequence < Other.Sequence);
+	}
+};
+
+/**
+ * A struct modifier stored inline by a dynamic property
+ */
+struct FDynamicPropertyStructModifierEntry
+{
+	/** Priority (lower values are applied first), insertion order and handle slot of the modifier */
+	FDynamicPropertyModifierOrderKey Key;
+
+	/** Linear form of the modifier, used when PooledIndex is INDEX_NONE */
+	FModifierLinearOp Op;
+
+	/** Slot of the property's struct modifier pool holding a modifier without a linear form */
+	int32 PooledIndex = INDEX_NONE;
+};
+
+/**
+ * A handle slot of a dynamic property, referring to one applied modifier while in use
+ */
+struct FDynamicPropertyModifierSlot
+{
+	/** Bumped every time the slot is freed, so handles to the previous modifier no longer match */
+	uint32 Generation = 1;
+
+	/** Ordering key of the modifier, used to find it in the sorted modifier arrays */
+	FDynamicPropertyModifierOrderKey Key;
+
+	/** The modifier object, or nullptr for a struct modifier; only compared, the modifiers array keeps it referenced */
+	UModifier* Modifier = nullptr;
+
+	/** Object the modifier was added on behalf of, if any */
+	FObjectKey Source;
+
+	/** Whether the slot currently refers to a modifier */
+	bool bInUse = false;
+
+	/** Whether the modifier is a struct modifier */
+	bool bStruct = false;
+};
+
 /**
  * A dynamic property that can have modifiers applied to modify its value
  */
@@ -20,9 +87,18 @@ class DYNAMICPROPERTIES_API UDynamicProperty : public UObject
 public:
 	UDynamicProperty();
 
+	virtual void Serialize(FArchive& Ar) override;
+
+	/**
+	 * Gets the heap memory held by native state, which reflection based memory counting doesn't see
+	 * Counted by Serialize when the archive counts memory
+	 * @return Allocated bytes
+	 */
+	SIZE_T GetAllocatedSize() const;
+
 protected:
 	/** The current calculated value after all modifiers */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dynamic Property")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, BlueprintGetter = GetValue, Category = "Dynamic Property")
 	float Value;
 
 	/** The base value before modifiers are applied */
@@ -33,6 +109,13 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dynamic Property")
 	TArray<UModifier*> Modifiers;
 
+	/**
+	 * If true, changes only mark the value dirty and it is recalculated when next read or flushed
+	 * Change events fire at that point instead of at the time of the change
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetLazyEvaluation, Category = "Dynamic Property")
+	bool bLazyEvaluation = false;
+
 public:
 	/** Event fired when the value changes */
 	UPROPERTY(BlueprintAssignable, Category = "Dynamic Property")
@@ -48,6 +131,7 @@ public:
 
 	/**
 	 * Recalculates the current value using the current base value
+	 * Modifiers are evaluated as last compiled, call UpdateModifier or RefreshModifiers after editing an applied modifier
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
 	void Recalculate();
@@ -55,9 +139,11 @@ public:
 	/**
 	 * Adds a modifier to the property and recalculates
 	 * @param Modifier The modifier to add
+	 * @param Source Optional object the modifier is applied on behalf of, see RemoveModifiersBySource
+	 * @return Handle of the added modifier, invalid if Modifier is nullptr
 	 */
-	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
-	void AddModifier(UModifier* Modifier);
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property", meta = (AdvancedDisplay = "Source"))
+	FModifierHandle AddModifier(UModifier* Modifier, UObject* Source = nullptr);
 
 	/**
 	 * Removes a modifier from the property and recalculates
@@ -67,11 +153,121 @@ public:
 	void RemoveModifier(UModifier* Modifier);
 
 	/**
-	 * Gets the current calculated value
+	 * Re-sorts and recompiles the modifiers and recalculates
+	 * Call after editing the modifiers array or the parameters of an applied modifier directly
+	 * Modifiers put in the array directly get new handles, handles of modifiers taken out of it become stale
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
+	void RefreshModifiers();
+
+	/**
+	 * Adds a struct modifier to the property and recalculates, without creating a UObject
+	 * Struct modifiers are applied together with modifier objects, by priority, and are not saved with the property
+	 * @param Modifier The modifier, a FDynamicPropertyModifier or a struct derived from it
+	 * @param Source Optional object the modifier is applied on behalf of, see RemoveModifiersBySource
+	 * @return Handle of the added modifier, invalid if the struct isn't a modifier
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property", meta = (BaseStruct = "/Script/DynamicProperties.DynamicPropertyModifier", AdvancedDisplay = "Source"))
+	FModifierHandle AddStructModifier(const FInstancedStruct& Modifier, UObject* Source = nullptr);
+
+	/**
+	 * Adds a struct modifier of a native type, linear modifiers don't allocate at all
+	 * @param Modifier The modifier to copy into the property
+	 * @param Source Optional object the modifier is applied on behalf of
+	 * @return Handle of the added modifier
+	 */
+	template <typename TModifier>
+	FModifierHandle AddStructModifier(const TModifier& Modifier, const UObject* Source = nullptr)
+	{
+		static_assert(TIsDerivedFrom<TModifier, FDynamicPropertyModifier>::Value, "TModifier must derive from FDynamicPropertyModifier");
+		return AddStructModifierOfType(TModifier::StaticStruct(), &Modifier, Source);
+	}
+
+	/**
+	 * Adds a struct modifier given its type and memory
+	 * @param ModifierType The type of the modifier, must derive from FDynamicPropertyModifier
+	 * @param ModifierMemory The modifier to copy into the property
+	 * @param Source Optional object the modifier is applied on behalf of
+	 * @return Handle of the added modifier, invalid if the struct isn't a modifier
+	 */
+	FModifierHandle AddStructModifierOfType(const UScriptStruct* ModifierType, const void* ModifierMemory, const UObject* Source = nullptr);
+
+	/**
+	 * Replaces a struct modifier in place and recalculates, keeping its handle
+	 * @param Handle The handle returned when the modifier was added
+	 * @param Modifier The new modifier, a FDynamicPropertyModifier or a struct derived from it
+	 * @return False if the handle is stale, refers to a modifier object or the struct isn't a modifier
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property", meta = (BaseStruct = "/Script/DynamicProperties.DynamicPropertyModifier"))
+	bool UpdateStructModifier(FModifierHandle Handle, const FInstancedStruct& Modifier);
+
+	/**
+	 * Moves a modifier object into place after its priority changed, recompiles its parameters and recalculates
+	 * Cheaper than RefreshModifiers when a single applied modifier object was edited
+	 * @param Handle The handle returned when the modifier was added
+	 * @return False if the handle is stale or refers to a struct modifier
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
+	bool UpdateModifier(FModifierHandle Handle);
+
+	/**
+	 * Removes a modifier object or struct modifier from the property and recalculates
+	 * @param Handle The handle returned when the modifier was added
+	 * @return True if the modifier was found and removed, false for stale handles
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
+	bool RemoveModifierByHandle(FModifierHandle Handle);
+
+	/**
+	 * Removes every modifier added on behalf of a source object and recalculates once
+	 * @param Source The object passed when the modifiers were added
+	 * @return Number of modifiers removed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
+	int32 RemoveModifiersBySource(const UObject* Source);
+
+	/**
+	 * Checks whether a handle still refers to a modifier applied to this property
+	 * @param Handle The handle to check
+	 * @return False if the handle was never valid or its modifier has been removed since
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Property")
+	bool IsModifierHandleValid(FModifierHandle Handle) const { return FindModifierSlot(Handle) != nullptr; }
+
+	/**
+	 * Gets the modifier object a handle refers to
+	 * @param Handle The handle returned when the modifier was added
+	 * @return The modifier object, or nullptr for stale handles and struct modifiers
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Property")
+	UModifier* GetModifierByHandle(FModifierHandle Handle) const;
+
+	/**
+	 * Adds a modifier that is removed automatically once its lifetime ends, by the world's UDynamicPropertiesSubsystem
+	 * @param Modifier The modifier to add
+	 * @param Duration Lifetime of the modifier, in seconds of world time
+	 * @param Source Optional object the modifier is applied on behalf of
+	 * @return Handle of the added modifier, invalid if Modifier is nullptr
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property", meta = (AdvancedDisplay = "Source"))
+	FModifierHandle AddTimedModifier(UModifier* Modifier, float Duration, UObject* Source = nullptr);
+
+	/**
+	 * Adds a struct modifier that is removed automatically once its lifetime ends, by the world's UDynamicPropertiesSubsystem
+	 * @param Modifier The modifier, a FDynamicPropertyModifier or a struct derived from it
+	 * @param Duration Lifetime of the modifier, in seconds of world time
+	 * @param Source Optional object the modifier is applied on behalf of
+	 * @return Handle of the added modifier, invalid if the struct isn't a modifier
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property", meta = (BaseStruct = "/Script/DynamicProperties.DynamicPropertyModifier", AdvancedDisplay = "Source"))
+	FModifierHandle AddTimedStructModifier(const FInstancedStruct& Modifier, float Duration, UObject* Source = nullptr);
+
+	/**
+	 * Gets the current calculated value, recalculating it first if it is dirty in lazy mode
 	 * @return The current value
 	 */
 	UFUNCTION(BlueprintGetter, Category = "Dynamic Property")
-	float GetValue() const { return Value; }
+	float GetValue() const { return bValueDirty && bLazyEvaluation && !IsBatching() ? GetValueSlow() : Value; }
 
 	/**
 	 * Gets the base value
@@ -87,10 +283,297 @@ public:
 	UFUNCTION(BlueprintSetter, Category = "Dynamic Property")
 	void SetBaseValue(float NewBaseValue);
 
+	/**
+	 * Starts a batch: modifier and base value changes are queued until the matching EndBatch
+	 * Batches can be nested, only the outermost EndBatch applies the queued changes
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
+	void BeginBatch();
+
+	/**
+	 * Ends a batch: sorts modifiers and recalculates once if anything changed while batching
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
+	void EndBatch();
+
+	/**
+	 * Checks whether changes to this property are currently being batched
+	 * @return True if inside a BeginBatch/EndBatch pair
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Property")
+	bool IsBatching() const { return BatchDepth > 0; }
+
+	/**
+	 * Enables or disables lazy evaluation, disabling it applies pending changes immediately
+	 * @param bInLazyEvaluation Whether the value should only be recalculated when read or flushed
+	 */
+	UFUNCTION(BlueprintSetter, Category = "Dynamic Property")
+	void SetLazyEvaluation(bool bInLazyEvaluation);
+
+	/**
+	 * Recalculates the value now if it is dirty, firing change events
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dynamic Property")
+	void FlushPendingChanges();
+
+	/**
+	 * Checks whether the value has pending changes that haven't been recalculated yet
+	 * @return True if the value is dirty
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Property")
+	bool IsValueDirty() const { return bValueDirty; }
+
+	/**
+	 * Gets the last calculated value without resolving pending lazy changes
+	 * @return The cached value
+	 */
+	float GetCachedValue() const { return Value; }
+
+	/**
+	 * Calculates the value for a base value through the compiled native program and keeps it for the next recalculation
+	 * Touches no other object, so it may run on a worker thread while nothing else mutates this property
+	 * @param InBaseValue The base value the next recalculation is expected to use
+	 * @param OutValue Set to the precomputed value
+	 * @return True if the modifier stack is fully native and the value was precomputed
+	 */
+	bool PrecomputeValue(float InBaseValue, float& OutValue);
+
+	/**
+	 * Gets the container this property belongs to
+	 * @return The owning container, or nullptr for standalone properties
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Property")
+	UDynamicPropertiesContainer* GetOwningContainer() const { return OwningContainer; }
+
+	/**
+	 * Gets the tag this property is registered under in its owning container
+	 * @return The property tag, or an empty tag for standalone properties
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dynamic Property")
+	FGameplayTag GetPropertyTag() const { return PropertyTag; }
+
 private:
+	friend class UDynamicPropertiesContainer;
+	friend struct FDynamicPropertiesSnapshot;
+
+	/** Container notified natively when the value changes */
+	UPROPERTY(Transient)
+	UDynamicPropertiesContainer* OwningContainer = nullptr;
+
+	/** Tag this property is registered under in OwningContainer */
+	UPROPERTY(Transient)
+	FGameplayTag PropertyTag;
+
+	/** Struct modifiers without a linear form, referenced by slot from StructModifiers */
+	UPROPERTY(Transient)
+	TArray<FInstancedStruct> StructModifierPool;
+
+	/** Nesting depth of open batches */
+	int32 BatchDepth = 0;
+
+	/** Struct modifiers sorted by priority, in insertion order for equal priorities */
+	TArray<FDynamicPropertyStructModifierEntry, TInlineAllocator<4>> StructModifiers;
+
+	/** Unused slots of StructModifierPool, their memory is reused by later modifiers of the same type */
+	TArray<int32> FreeStructModifierSlots;
+
+	/** Sequence given to the next struct modifier */
+	uint32 NextStructModifierSequence = 0;
+
+	/** Handle slots of all applied modifiers, objects and structs alike */
+	TArray<FDynamicPropertyModifierSlot> ModifierSlots;
+
+	/** Unused entries of ModifierSlots */
+	TArray<int32> FreeModifierSlots;
+
+	/** Handle slots of the modifiers added on behalf of each source object */
+	TMap<FObjectKey, TArray<int32, TInlineAllocator<4>>> ModifierSlotsBySource;
+
+	/** Whether the modifiers need to be compiled when the batch ends */
+	bool bModifiersDirty = false;
+
+	/** Whether the modifiers array needs to be reordered when the batch ends, after a refresh */
+	bool bModifierOrderDirty = false;
+
+	/** Ordering keys of the modifiers array, parallel to it and sorted */
+	TArray<FDynamicPropertyModifierOrderKey> ModifierOrder;
+
+	/** Sequence given to the next modifier object */
+	uint32 NextModifierSequence = 0;
+
+	/** Whether the value needs to be recalculated, when the batch ends or when next read in lazy mode */
+	bool bValueDirty = false;
+
+	/** Modifiers compiled to their linear form, in application order */
+	TArray<FModifierLinearOp> ModifierProgram;
+
+	/** Whether ModifierProgram matches the modifiers array; false when any modifier has to go through Apply */
+	bool bModifierProgramValid = false;
+
+	/** Whether PrecomputedValue holds the result of the program for PrecomputedBaseValue */
+	bool bHasPrecomputedValue = false;
+
+	/** Base value used by the last PrecomputeValue call */
+	float PrecomputedBaseValue = 0.0f;
+
+	/** Value computed by the last PrecomputeValue call */
+	float PrecomputedValue = 0.0f;
+
+	/**
+	 * Stable sorts the modifiers array by priority and rebuilds its ordering keys
+	 * Needed after modifier priorities or the modifiers array were edited directly
+	 * Modifiers keep their handle slot, modifiers new to the array get one and slots of missing modifiers are freed
+	 */
+	void RebuildModifierOrder();
+
+	/**
+	 * Rebuilds the ordering keys if they no longer match the modifiers array
+	 */
+	void EnsureModifierOrder()
+	{
+		if (ModifierOrder.Num() != Modifiers.Num())
+		{
+			RebuildModifierOrder();
+		}
+	}
+
+	/**
+	 * Registers the property with its owning container, or clears the registration when passed nullptr
+	 * @param InContainer The owning container
+	 * @param InPropertyTag The tag the property is registered under
+	 */
+	void SetOwningContainer(UDynamicPropertiesContainer* InContainer, FGameplayTag InPropertyTag);
+
+	/**
+	 * Notifies the owning container and ValueChanged listeners of a value change
+	 * @param OldValue The previous value
+	 * @param NewValue The new value
+	 */
+	void NotifyValueChanged(float OldValue, float NewValue);
+
+	/**
+	 * Broadcasts ValueChanged to Blueprint listeners only, if any are bound
+	 * @param OldValue The previous value
+	 * @param NewValue The new value
+	 */
+	void BroadcastValueChanged(float OldValue, float NewValue);
+
+	/**
+	 * Sets the base value and recalculates without notifying anyone, deferring like SetBaseValue while batching or lazy
+	 * @param NewBaseValue The new base value
+	 * @param OutOldValue Set to the value before recalculation
+	 * @return True if the value was recalculated now and changed
+	 */
+	bool SetBaseValueSilently(float NewBaseValue, float& OutOldValue);
+
 	/**
-	 * Sorts the modifiers array by priority
+	 * Recalculates now, defers to the end of the batch, or marks the value dirty in lazy mode
 	 */
-	void SortModifiers();
+	void ApplyValueChange();
+
+	/**
+	 * Marks the value dirty and tells the owning container about it
+	 */
+	void MarkValueDirty();
+
+	/**
+	 * Flushes pending changes and returns the value, out of line part of GetValue
+	 */
+	float GetValueSlow() const;
+
+	/**
+	 * Compiles the modifiers into ModifierProgram if every one of them has a native linear form
+	 */
+	void CompileModifiers();
+
+	/**
+	 * Visits modifier objects and struct modifiers merged by priority, modifier objects first for equal priorities
+	 * @param VisitObject Called with each modifier object, returns false to stop
+	 * @param VisitStruct Called with each struct modifier entry, returns false to stop
+	 * @return False if a visitor stopped the iteration
+	 */
+	template <typename ObjectVisitorType, typename StructVisitorType>
+	bool VisitModifiersInOrder(ObjectVisitorType&& VisitObject, StructVisitorType&& VisitStruct) const;
+
+	/**
+	 * Applies a struct modifier entry to a value
+	 */
+	float ApplyStructModifier(const FDynamicPropertyStructModifierEntry& Entry, float InBaseValue, float CurrentValue) const;
+
+	/**
+	 * Copies a struct modifier into a pool slot, reusing a free slot when possible
+	 * @return The slot index
+	 */
+	int32 AllocateStructModifierSlot(const UScriptStruct* ModifierType, const void* ModifierMemory);
+
+	/**
+	 * Marks the modifiers dirty while batching, otherwise compiles them and applies the value change
+	 * @param bReorder Whether the modifier objects need to be reordered, because priorities may have changed
+	 */
+	void OnModifiersChanged(bool bReorder);
+
+	/**
+	 * Inserts a struct modifier entry in priority order and gives it a handle slot, without recalculating
+	 * @param Entry The entry, with its priority and linear op set
+	 * @param ModifierType Type of a modifier without a linear form, copied into the pool, or nullptr
+	 * @param ModifierMemory The modifier to copy into the pool
+	 * @param Source Object the modifier is applied on behalf of, or nullptr
+	 * @return Handle of the inserted modifier
+	 */
+	FModifierHandle InsertStructModifier(FDynamicPropertyStructModifierEntry Entry, const UScriptStruct* ModifierType, const void* ModifierMemory, const UObject* Source);
+
+	/**
+	 * Releases the pool slot of a struct modifier entry, if it has one
+	 */
+	void ReleaseStructModifierPoolSlot(const FDynamicPropertyStructModifierEntry& Entry);
+
+	/**
+	 * Takes a free handle slot for a modifier
+	 * @param Modifier The modifier object, or nullptr for a struct modifier
+	 * @param Source Object the modifier is applied on behalf of, or nullptr
+	 * @return Index of the slot
+	 */
+	int32 AllocateModifierSlot(UModifier* Modifier, const UObject* Source);
+
+	/**
+	 * Frees a handle slot, making handles to it stale
+	 */
+	void FreeModifierSlot(int32 SlotIndex);
+
+	/**
+	 * Gets the slot a handle refers to
+	 * @return The slot, or nullptr if the handle is stale
+	 */
+	const FDynamicPropertyModifierSlot* FindModifierSlot(FModifierHandle Handle) const
+	{
+		if (!ModifierSlots.IsValidIndex(Handle.GetIndex()))
+		{
+			return nullptr;
+		}
+
+		const FDynamicPropertyModifierSlot& Slot = ModifierSlots[Handle.GetIndex()];
+		return Slot.bInUse && Slot.Generation == Handle.GetGeneration() ? &Slot : nullptr;
+	}
+
+	/**
+	 * Finds the position of the modifier of a slot in Modifiers or StructModifiers
+	 * @return The position, or INDEX_NONE if not found
+	 */
+	int32 FindModifierPosition(int32 SlotIndex) const;
+
+	/**
+	 * Removes the modifier of a slot and frees the slot, without recalculating
+	 * @return True if the modifier was found
+	 */
+	bool RemoveModifierInSlot(int32 SlotIndex);
+
+	/**
+	 * Schedules the removal of a modifier with the world subsystem
+	 * @return False if the property isn't in a world
+	 */
+	bool ScheduleModifierExpiration(UModifier* Modifier, FModifierHandle Handle, float Duration);
 };
 
+/** Scoped batch of changes to a single dynamic property */
+using FDynamicPropertyBatchScope = TDynamicPropertiesBatchScope<UDynamicProperty>;
+
@@ -0,0 +1,86 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modifier.h"
+#include "DynamicPropertyModifier.generated.h"
+
+/**
+ * Base struct for lightweight modifiers stored inline by dynamic properties, without a UObject per modifier
+ * Linear modifiers are stored as their linear form only; other types are kept in a pooled FInstancedStruct
+ */
+USTRUCT(BlueprintType)
+struct DYNAMICPROPERTIES_API FDynamicPropertyModifier
+{
+	GENERATED_BODY()
+
+	virtual ~FDynamicPropertyModifier() = default;
+
+	/** Priority for modifier application order (lower values are applied first) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	int32 Priority = 0;
+
+	/**
+	 * Applies the modifier to a value
+	 * @param BaseValue The original base value
+	 * @param CurrentValue The current value after previous modifiers
+	 * @return The modified value
+	 */
+	virtual float Apply(float BaseValue, float CurrentValue) const { return CurrentValue; }
+
+	/**
+	 * Gets the linear form of this modifier
+	 * @param OutOp Filled with the linear form of the modifier
+	 * @return True if the modifier can be evaluated as a linear op
+	 */
+	virtual bool GetLinearOp(FModifierLinearOp& OutOp) const { return false; }
+};
+
+/**
+ * Struct modifier that adds a constant value to the current value
+ */
+USTRUCT(BlueprintType)
+struct DYNAMICPROPERTIES_API FDynamicPropertyModifierAdd : public FDynamicPropertyModifier
+{
+	GENERATED_BODY()
+
+	/** The value to add */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	float AdditiveValue = 0.0f;
+
+	virtual float Apply(float BaseValue, float CurrentValue) const override { return CurrentValue + AdditiveValue; }
+	virtual bool GetLinearOp(FModifierLinearOp& OutOp) const override;
+};
+
+/**
+ * Struct modifier that multiplies the current value
+ */
+USTRUCT(BlueprintType)
+struct DYNAMICPROPERTIES_API FDynamicPropertyModifierScale : public FDynamicPropertyModifier
+{
+	GENERATED_BODY()
+
+	/** The multiplier to apply */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	float Multiplier = 1.0f;
+
+	virtual float Apply(float BaseValue, float CurrentValue) const override { return CurrentValue * Multiplier; }
+	virtual bool GetLinearOp(FModifierLinearOp& OutOp) const override;
+};
+
+/**
+ * Struct modifier that adds a scaled percentage of the base value to the current value
+ */
+USTRUCT(BlueprintType)
+struct DYNAMICPROPERTIES_API FDynamicPropertyModifierAddScaledBase : public FDynamicPropertyModifier
+{
+	GENERATED_BODY()
+
+	/** The multiplier to scale the base value by before adding */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+	float BaseMultiplier = 0.0f;
+
+	virtual float Apply(float BaseValue, float CurrentValue) const override { return CurrentValue + BaseValue * BaseMultiplier; }
+	virtual bool GetLinearOp(FModifierLinearOp& OutOp) const override;
+};
@@ -0,0 +1,243 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Modifier.h"
+
+class UDynamicPropertiesContainer;
+
+/**
+ * Lightweight handle to a property kept in a container's compact storage
+ * The index is a cache: removing a property moves the last one into its slot, after which handles to the moved
+ * property resolve through their tag instead. A handle stops resolving once its property leaves compact storage,
+ * either removed or turned into a property object
+ */
+struct FDynamicPropertyHandle
+{
+	/** Index of the property in the compact storage arrays */
+	int32 Index = INDEX_NONE;
+
+	/** Tag of the property, used to detect stale handles */
+	FGameplayTag Tag;
+
+	FDynamicPropertyHandle() = default;
+
+	FDynamicPropertyHandle(int32 InIndex, FGameplayTag InTag)
+		: Index(InIndex)
+		, Tag(InTag)
+	{
+	}
+
+	/** Checks whether the handle was ever bound to a property */
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FDynamicPropertyHandle& Other) const { return Index == Other.Index && Tag == Other.Tag; }
+	bool operator!=(const FDynamicPropertyHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FDynamicPropertyHandle& Handle) { return HashCombine(::GetTypeHash(Handle.Index), GetTypeHash(Handle.Tag)); }
+};
+
+/**
+ * Struct-of-arrays storage for dynamic properties
+ * Base values, current values and modifier ranges live in contiguous arrays indexed by a compact per-container index,
+ * instead of one UDynamicProperty object per property
+ * Each modifier range keeps slack at its end, so adding or removing a modifier only moves the modifiers of its own property.
+ * A full range moves to the end of the modifier arrays with twice the room, and the holes it leaves are packed once they
+ * make up half of the arrays
+ */
+struct DYNAMICPROPERTIES_API FDynamicPropertyStore
+{
+	/** Container owning the storage, passed to modifiers reading other properties */
+	UDynamicPropertiesContainer* Owner = nullptr;
+
+	/**
+	 * Adds a property
+	 * @param Tag The gameplay tag identifying the property, must not already be stored
+	 * @param BaseValue The base value of the new property
+	 * @return Handle to the new property
+	 */
+	FDynamicPropertyHandle Add(FGameplayTag Tag, float BaseValue);
+
+	/**
+	 * Reserves room for properties about to be added
+	 * @param NumProperties Number of properties to make room for in total
+	 */
+	void Reserve(int32 NumProperties);
+
+	/**
+	 * Removes a property, the last property takes over its index so handles to it fall back to their tag
+	 * @param Tag The gameplay tag identifying the property
+	 * @param OutModifiers Optional array to be filled with the modifiers of the removed property
+	 * @return True if the property was stored and removed
+	 */
+	bool Remove(FGameplayTag Tag, TArray<UModifier*>* OutModifiers = nullptr);
+
+	/**
+	 * Removes all properties
+	 */
+	void Reset();
+
+	/**
+	 * Gets the heap memory held by the storage arrays
+	 * @return Allocated bytes
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Finds the handle of a property
+	 * @param Tag The gameplay tag identifying the property
+	 * @return Handle to the property, or an invalid handle if not stored
+	 */
+	FDynamicPropertyHandle Find(FGameplayTag Tag) const;
+
+	/**
+	 * Resolves a handle to an index into the storage arrays, looking the tag up if the property has moved
+	 * @param Handle The handle to resolve
+	 * @return The index, or INDEX_NONE if the property is no longer stored
+	 */
+	int32 Resolve(const FDynamicPropertyHandle& Handle) const
+	{
+		if (Tags.IsValidIndex(Handle.Index) && Tags[Handle.Index] == Handle.Tag)
+		{
+			return Handle.Index;
+		}
+
+		const int32* Index = Handle.Tag.IsValid() ? TagToIndex.Find(Handle.Tag) : nullptr;
+		return Index ? *Index : INDEX_NONE;
+	}
+
+	/** Gets the number of stored properties */
+	int32 Num() const { return Tags.Num(); }
+
+	/** Gets the tags of all stored properties, in index order */
+	const TArray<FGameplayTag>& GetTags() const { return Tags; }
+
+	FGameplayTag GetTag(int32 Index) const { return Tags[Index]; }
+	float GetValue(int32 Index) const { return Values[Index]; }
+	float GetBaseValue(int32 Index) const { return BaseValues[Index]; }
+
+	/** Overrides the current value of a property, until it is next recalculated */
+	void SetValue(int32 Index, float NewValue) { Values[Index] = NewValue; }
+
+	/**
+	 * Sets the base value of a property, without recalculating
+	 * @return True if the base value changed
+	 */
+	bool SetBaseValue(int32 Index, float NewBaseValue);
+
+	/**
+	 * Inserts a modifier in the property's modifier range, ordered by priority, without recalculating
+	 * @return True if the modifier was added
+	 */
+	bool AddModifier(int32 Index, UModifier* Modifier);
+
+	/**
+	 * Removes a modifier from the property's modifier range, without recalculating
+	 * @return True if the modifier was found and removed
+	 */
+	bool RemoveModifier(int32 Index, UModifier* Modifier);
+
+	/**
+	 * Re-reads the linear form of every modifier of a property, after modifier parameters were edited
+	 */
+	void RefreshModifiers(int32 Index);
+
+	/**
+	 * Gets the modifiers of a property, in application order
+	 * @param OutModifiers Array to be filled with the modifiers
+	 */
+	void GetModifiers(int32 Index, TArray<UModifier*>& OutModifiers) const;
+
+	/**
+	 * Calculates the value of a property for a given base value by applying its modifiers
+	 */
+	float CalculateForBaseValue(int32 Index, float InBaseValue) const;
+
+	/**
+	 * Recalculates the current value of a property from its base value
+	 * @param OutOldValue The value before recalculation
+	 * @return True if the value changed
+	 */
+	bool Recalculate(int32 Index, float& OutOldValue);
+
+	/**
+	 * Recalculates every property at once, evaluating native modifier stacks with the vectorized batch kernel
+	 * Pending recalculation marks are cleared
+	 * @param OutChangedIndices Array to be filled with the indices of the properties whose value changed
+	 * @param OutOldValues Array to be filled with the values before recalculation, parallel to OutChangedIndices
+	 */
+	void RecalculateAll(TArray<int32>& OutChangedIndices, TArray<float>& OutOldValues);
+
+	/** Marks a property for recalculation when the owning container's batch ends */
+	void MarkDirty(int32 Index) { Dirty[Index] = true; }
+
+	/**
+	 * Clears the pending recalculation mark of a property
+	 * @return True if the property was marked
+	 */
+	bool ConsumeDirty(int32 Index)
+	{
+		const bool bWasDirty = Dirty[Index];
+		Dirty[Index] = false;
+		return bWasDirty;
+	}
+
+	/** Reports the stored modifiers to the garbage collector */
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+private:
+	/** A modifier applied to a stored property */
+	struct FStoredModifier
+	{
+		/** The modifier object, kept for identity, Blueprint evaluation and garbage collection */
+		UModifier* Modifier = nullptr;
+
+		/** Priority of the modifier when it was added or last refreshed, ranges are sorted on it */
+		int32 Priority = 0;
+
+		/** Whether the modifier can be evaluated without calling Apply */
+		bool bIsLinear = false;
+	};
+
+	/** Maps tags to indices in the storage arrays */
+	TMap<FGameplayTag, int32> TagToIndex;
+
+	/** Per-property arrays, all indexed by property index */
+	TArray<FGameplayTag> Tags;
+	TArray<float> BaseValues;
+	TArray<float> Values;
+	TArray<int32> ModifierStarts;
+	TArray<int32> ModifierCounts;
+	TArray<int32> ModifierCapacities;
+	TArray<int32> NonLinearModifierCounts;
+	TBitArray<> Dirty;
+
+	/**
+	 * Modifiers of all properties, each property owning the range [ModifierStarts, ModifierStarts + ModifierCapacities)
+	 * of which the first ModifierCounts entries are in use
+	 */
+	TArray<FStoredModifier> Modifiers;
+
+	/** Linear form of each entry of Modifiers, kept in a parallel array for the batch kernel (identity for non-linear modifiers) */
+	TArray<FModifierLinearOp> ModifierOps;
+
+	/** Number of entries of Modifiers owned by no property */
+	int32 NumUnusedModifiers = 0;
+
+	/**
+	 * Makes room for one more modifier in a property's range, moving the range to the end of the modifier arrays if it is full
+	 */
+	void GrowModifierRange(int32 Index);
+
+	/**
+	 * Releases the entries of a range, packing the modifier arrays once enough of them are unused
+	 */
+	void ReleaseModifierRange(int32 Start, int32 Capacity);
+
+	/**
+	 * Moves every modifier range next to the previous one, dropping the unused entries in between
+	 */
+	void PackModifierRanges();
+};
@@ -4,8 +4,38 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "GameplayTagContainer.h"
 #include "Modifier.generated.h"
 
+class UDynamicPropertiesContainer;
+
+/**
+ * Native linear form of a modifier: Result = CurrentValue * CurrentScale + BaseValue * BaseScale + Offset
+ * Built-in modifiers compile to this form so properties can evaluate them without going through the Apply event
+ */
+struct FModifierLinearOp
+{
+	/** Factor applied to the value produced by previous modifiers */
+	float CurrentScale = 1.0f;
+
+	/** Factor applied to the property's base value */
+	float BaseScale = 0.0f;
+
+	/** Constant added to the result */
+	float Offset = 0.0f;
+
+	/**
+	 * Applies the op to a value
+	 * @param BaseValue The original base value
+	 * @param CurrentValue The current value after previous modifiers
+	 * @return The modified value
+	 */
+	FORCEINLINE float Apply(float BaseValue, float CurrentValue) const
+	{
+		return CurrentValue * CurrentScale + BaseValue * BaseScale + Offset;
+	}
+};
+
 /**
  * Abstract base class for modifiers that can be applied to dynamic properties
  */
@@ -30,5 +60,66 @@ public:
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Modifier")
 	float Apply(float BaseValue, float CurrentValue);
 	virtual float Apply_Implementation(float BaseValue, float CurrentValue);
+
+	/**
+	 * Applies the modifier to a value of a property of a container, as properties and compact storage do
+	 * Modifiers reading other properties read them from Container, so they agree with the container's dependencies
+	 * @param BaseValue The original base value
+	 * @param CurrentValue The current value after previous modifiers
+	 * @param Container The container of the property being evaluated, may be nullptr
+	 * @return The modified value
+	 */
+	virtual float ApplyInContainer(float BaseValue, float CurrentValue, UDynamicPropertiesContainer* Container) { return Apply(BaseValue, CurrentValue); }
+
+	/**
+	 * Gets the native linear form of this modifier, used by properties to evaluate it without calling Apply
+	 * Fails when Apply is overridden in Blueprint
+	 * Properties read it when the modifier is added or refreshed, not on every recalculation
+	 * @param OutOp Filled with the linear form of the modifier
+	 * @return True if the modifier can be evaluated as a linear op
+	 */
+	bool GetLinearOp(FModifierLinearOp& OutOp) const;
+
+	/**
+	 * Gets the properties of the owning container this modifier reads, so the container recalculates when they change
+	 * Refresh the property's modifiers after the set of properties changes
+	 * @param OutTags Array to append the property tags to
+	 */
+	virtual void GetPropertyDependencies(TArray<FGameplayTag>& OutTags) const {}
+
+	/**
+	 * Gets the heap memory held by native state, which reflection based memory counting doesn't see
+	 * Modifiers with native state override this and count it in Serialize
+	 * @return Allocated bytes
+	 */
+	virtual SIZE_T GetAllocatedSize() const { return 0; }
+
+protected:
+	/**
+	 * Checks that Apply isn't overridden in Blueprint, so the native implementation is the one that runs
+	 * Looked up once per class
+	 */
+	bool IsApplyNative() const;
+
+	/**
+	 * Native hook for GetLinearOp - override in native modifiers that are linear, together with GetNativeLinearOpClass
+	 * Native subclasses of a linear modifier are evaluated through Apply unless they override both again
+	 * @param OutOp Filled with the linear form of the modifier
+	 * @return True if the modifier can be evaluated as a linear op
+	 */
+	virtual bool GetNativeLinearOp(FModifierLinearOp& OutOp) const;
+
+	/**
+	 * Gets the native class whose Apply_Implementation GetNativeLinearOp describes
+	 * @return The class overriding GetNativeLinearOp, nullptr if the modifier is not linear
+	 */
+	virtual const UClass* GetNativeLinearOpClass() const { return nullptr; }
+
+private:
+	/**
+	 * Gets what GetLinearOp needs to know about the class of this modifier, computed on first use and cached per class
+	 * @return ModifierClassTraits flags
+	 */
+	uint8 GetClassTraits() const;
 };
 
@@ -22,5 +22,9 @@ public:
 	float BaseMultiplier;
 
 	virtual float Apply_Implementation(float BaseValue, float CurrentValue) override;
+
+protected:
+	virtual bool GetNativeLinearOp(FModifierLinearOp& OutOp) const override;
+	virtual const UClass* GetNativeLinearOpClass() const override { return UModifierAddScaledBase::StaticClass(); }
 };
 
@@ -0,0 +1,170 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Modifier.h"
+#include "ModifierExpression.generated.h"
+
+class UDynamicPropertiesContainer;
+
+/**
+ * Operation of a compiled expression instruction
+ */
+enum class EModifierExpressionOp : uint8
+{
+	LoadConstant,
+	LoadBase,
+	LoadCurrent,
+	LoadProperty,
+	Add,
+	Subtract,
+	Multiply,
+	Divide,
+	Negate,
+	Min,
+	Max,
+	Clamp,
+	Abs,
+	Floor,
+	Ceil,
+	Round,
+	Sqrt,
+};
+
+/**
+ * A compiled expression instruction: Registers[Target] = Op(Registers[Target], Registers[Target + 1], Registers[Target + 2])
+ * Load instructions read Operand instead, an index into the constant or property tag table
+ */
+struct FModifierExpressionInstruction
+{
+	EModifierExpressionOp Op = EModifierExpressionOp::LoadConstant;
+
+	/** Register receiving the result, operands are read from it and the registers after it */
+	uint8 Target = 0;
+
+	/** Index into the constant or property tag table, for load instructions */
+	uint16 Operand = 0;
+};
+
+/**
+ * Modifier computing the new value from a formula, compiled once to native bytecode instead of running a Blueprint graph
+ *
+ * Supported syntax:
+ *  - Base and Current (or BaseValue and CurrentValue) for the values passed to Apply
+ *  - [Some.Property.Tag] for the value of another property of the owning container
+ *  - numbers, + - * / with the usual precedence, unary minus and parentheses
+ *  - min(a, b), max(a, b), clamp(x, lo, hi), abs(x), floor(x), ceil(x), round(x), sqrt(x)
+ * Division by zero and the square root of a negative number evaluate to 0
+ */
+UCLASS(Blueprintable, BlueprintType)
+class DYNAMICPROPERTIES_API UModifierExpression : public UModifier
+{
+	GENERATED_BODY()
+
+public:
+	UModifierExpression();
+
+	/** Most registers a compiled expression may use, bounds the nesting depth of the formula */
+	static constexpr int32 MaxRegisters = 16;
+
+	/** Most parentheses and signs an operand may be nested in, they don't take registers but are parsed recursively */
+	static constexpr int32 MaxNesting = 64;
+
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+	virtual void Serialize(FArchive& Ar) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	virtual float Apply_Implementation(float BaseValue, float CurrentValue) override;
+	virtual float ApplyInContainer(float BaseValue, float CurrentValue, UDynamicPropertiesContainer* InContainer) override;
+	virtual void GetPropertyDependencies(TArray<FGameplayTag>& OutTags) const override;
+	virtual SIZE_T GetAllocatedSize() const override;
+
+	/**
+	 * Replaces the formula and compiles it
+	 * Refresh the modifiers of properties it is applied to if it reads different properties than before
+	 * @param NewExpression The formula
+	 * @return True if the formula compiled, otherwise the modifier leaves values unchanged
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Modifier")
+	bool SetExpression(const FString& NewExpression);
+
+	/**
+	 * Gets the error of the last compilation
+	 * @return The error, empty if the formula compiled
+	 */
+	UFUNCTION(BlueprintPure, Category = "Modifier")
+	const FString& GetCompileError() const { return CompileError; }
+
+	/**
+	 * Sets the container whose properties are read by [Tag] references when Apply is called directly
+	 * Properties evaluating the modifier always read from their own container instead
+	 * Defaults to the container the modifier was created in, if any
+	 * @param InContainer The container to read from
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Modifier")
+	void SetContainer(UDynamicPropertiesContainer* InContainer) { Container = InContainer; }
+
+	/**
+	 * Gets the property tags referenced by the formula
+	 * @return The referenced tags, each once
+	 */
+	const TArray<FGameplayTag>& GetReferencedTags() const { return ReferencedTags; }
+
+	/**
+	 * Evaluates the compiled formula
+	 * @param BaseValue The original base value
+	 * @param CurrentValue The current value after previous modifiers
+	 * @param OutValue Set to the result
+	 * @param ReadContainer Container read by [Tag] references, the one set by SetContainer if nullptr
+	 * @return False if the formula didn't compile
+	 */
+	bool Evaluate(float BaseValue, float CurrentValue, float& OutValue, UDynamicPropertiesContainer* ReadContainer = nullptr) const;
+
+protected:
+	/** The formula computing the new value */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Modifier", meta = (ExposeOnSpawn = "true"))
+	FString Expression;
+
+	/** Error of the last compilation, empty if the formula compiled */
+	UPROPERTY(VisibleAnywhere, Transient, Category = "Modifier")
+	FString CompileError;
+
+private:
+	/** Container read by [Tag] references */
+	UPROPERTY(Transient)
+	TWeakObjectPtr<UDynamicPropertiesContainer> Container;
+
+	/** Compiled formula */
+	TArray<FModifierExpressionInstruction> Program;
+
+	/** Numbers used by the formula */
+	TArray<float> Constants;
+
+	/** Property tags referenced by the formula */
+	TArray<FGameplayTag> ReferencedTags;
+
+	/** Whether Program holds the compiled Expression */
+	bool bCompiled = false;
+
+	/** Whether Expression was compiled since it was last set, successfully or not */
+	bool bCompileAttempted = false;
+
+	/** Whether Apply isn't overridden in Blueprint, found once when the modifier is created */
+	bool bApplyNative = true;
+
+	/**
+	 * Compiles Expression into Program, setting CompileError on failure
+	 * @return True if the formula compiled
+	 */
+	bool Compile();
+
+	/**
+	 * Gets the container read by [Tag] references
+	 */
+	UDynamicPropertiesContainer* GetContainer() const;
+};
@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModifierHandle.generated.h"
+
+/**
+ * Identifies a modifier applied to a dynamic property, returned when the modifier is added
+ * Handles stay valid until the modifier is removed, after which they are detected as stale
+ */
+USTRUCT(BlueprintType)
+struct DYNAMICPROPERTIES_API FModifierHandle
+{
+	GENERATED_BODY()
+
+	FModifierHandle() = default;
+
+	FModifierHandle(int32 InIndex, uint32 InGeneration)
+		: Index(InIndex)
+		, Generation(InGeneration)
+	{
+	}
+
+	/** Whether the handle was returned by an add at all, it may still be stale */
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	/** Slot of the modifier in its property */
+	int32 GetIndex() const { return Index; }
+
+	/** Generation of the slot when the modifier was added */
+	uint32 GetGeneration() const { return Generation; }
+
+	bool operator==(const FModifierHandle& Other) const
+	{
+		return Index == Other.Index && Generation == Other.Generation;
+	}
+
+	bool operator!=(const FModifierHandle& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	friend uint32 GetTypeHash(const FModifierHandle& Handle)
+	{
+		return HashCombine(::GetTypeHash(Handle.Index), ::GetTypeHash(Handle.Generation));
+	}
+
+private:
+	/** Slot of the modifier in its property */
+	int32 Index = INDEX_NONE;
+
+	/** Generation of the slot, bumped every time a modifier leaves it */
+	uint32 Generation = 0;
+};
@@ -0,0 +1,99 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Modifier.h"
+#include "SharedModifier.generated.h"
+
+class UDynamicPropertiesContainer;
+
+/**
+ * A property of a container that applies a shared modifier
+ */
+USTRUCT()
+struct FSharedModifierSubscription
+{
+	GENERATED_BODY()
+
+	/** The subscribed container */
+	UPROPERTY()
+	TWeakObjectPtr<UDynamicPropertiesContainer> Container;
+
+	/** The property of Container the modifier is applied to */
+	UPROPERTY()
+	FGameplayTag PropertyTag;
+};
+
+/**
+ * Modifier whose parameters are stored once and applied to any number of containers, e.g. for auras and zone effects
+ * Containers subscribe to it by tag instead of receiving their own copy, and a change to it is pushed to all of them together
+ * Its Priority decides where it is applied, the priority of the wrapped modifier is ignored
+ */
+UCLASS(Blueprintable, BlueprintType)
+class DYNAMICPROPERTIES_API USharedModifier : public UModifier
+{
+	GENERATED_BODY()
+
+public:
+	USharedModifier();
+
+	virtual float Apply_Implementation(float BaseValue, float CurrentValue) override;
+	virtual float ApplyInContainer(float BaseValue, float CurrentValue, UDynamicPropertiesContainer* Container) override;
+	virtual void GetPropertyDependencies(TArray<FGameplayTag>& OutTags) const override;
+
+	/**
+	 * Gets the modifier applied on behalf of every subscriber
+	 * @return The wrapped modifier, or nullptr if the shared modifier leaves values unchanged
+	 */
+	UFUNCTION(BlueprintPure, Category = "Modifier")
+	UModifier* GetModifier() const { return Modifier; }
+
+	/**
+	 * Replaces the wrapped modifier and updates every subscriber
+	 * @param NewModifier The modifier to apply from now on
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Modifier")
+	void SetModifier(UModifier* NewModifier);
+
+	/**
+	 * Updates every subscriber after the parameters of the wrapped modifier or the priority were edited
+	 * Each subscribed container is changed in a single batch, so each affected property is recalculated once
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Modifier")
+	void NotifyModifierChanged();
+
+	/**
+	 * Gets the number of properties the modifier is applied to
+	 * @return The number of subscriptions, including ones of containers destroyed since
+	 */
+	UFUNCTION(BlueprintPure, Category = "Modifier")
+	int32 GetNumSubscribers() const { return Subscriptions.Num(); }
+
+protected:
+	virtual bool GetNativeLinearOp(FModifierLinearOp& OutOp) const override;
+	virtual const UClass* GetNativeLinearOpClass() const override { return USharedModifier::StaticClass(); }
+
+private:
+	friend class UDynamicPropertiesContainer;
+	friend struct FDynamicPropertiesSnapshot;
+
+	/** The modifier applied on behalf of every subscriber */
+	UPROPERTY(EditAnywhere, Instanced, Category = "Modifier")
+	UModifier* Modifier = nullptr;
+
+	/** Properties the modifier is applied to */
+	UPROPERTY(Transient)
+	TArray<FSharedModifierSubscription> Subscriptions;
+
+	/**
+	 * Records a subscription, called by the container once the modifier is applied
+	 */
+	void AddSubscriber(UDynamicPropertiesContainer* Container, FGameplayTag PropertyTag);
+
+	/**
+	 * Forgets a subscription, called by the container for each applied instance of the modifier it removes
+	 */
+	void RemoveSubscriber(UDynamicPropertiesContainer* Container, FGameplayTag PropertyTag);
+};
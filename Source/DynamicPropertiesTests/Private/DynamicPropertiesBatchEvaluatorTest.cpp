@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DynamicPropertiesBatchEvaluator.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+namespace DynamicPropertiesBatchEvaluatorTest
+{
+	/** Equal values, or NaN on both sides */
+	bool IsSameValue(float A, float B)
+	{
+		return A == B || (FMath::IsNaN(A) && FMath::IsNaN(B));
+	}
+
+	/** Base values covering ordinary numbers and the non-finite ones */
+	TArray<float> MakeBaseValues(int32 NumProperties, FRandomStream& Random)
+	{
+		const float Special[] = { TNumericLimits<float>::Max(), -TNumericLimits<float>::Max(), INFINITY, -INFINITY, NAN, 0.0f, -0.0f };
+
+		TArray<float> BaseValues;
+		for (int32 Property = 0; Property < NumProperties; ++Property)
+		{
+			BaseValues.Add(Property % 3 == 2 ? Special[Property % UE_ARRAY_COUNT(Special)] : Random.FRandRange(-1000.0f, 1000.0f));
+		}
+		return BaseValues;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertiesEvaluateStacksTest, "DynamicProperties.BatchEvaluator.EvaluateStacks", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertiesEvaluateStacksTest::RunTest(const FString& Parameters)
+{
+	using namespace DynamicPropertiesBatchEvaluatorTest;
+
+	FRandomStream Random(1234);
+
+	// Property counts around and between multiples of the vector width
+	for (int32 NumProperties = 0; NumProperties <= 13; ++NumProperties)
+	{
+		const TArray<float> BaseValues = MakeBaseValues(NumProperties, Random);
+
+		// Ragged stacks, including empty ones next to long ones in the same vector
+		TArray<FModifierLinearOp> Ops;
+		TArray<int32> OpStarts;
+		TArray<int32> OpCounts;
+		for (int32 Property = 0; Property < NumProperties; ++Property)
+		{
+			const int32 Count = (Property * 7) % 6;
+			OpStarts.Add(Ops.Num());
+			OpCounts.Add(Count);
+			for (int32 Step = 0; Step < Count; ++Step)
+			{
+				FModifierLinearOp& Op = Ops.AddDefaulted_GetRef();
+				Op.CurrentScale = Random.FRandRange(0.5f, 1.5f);
+				Op.BaseScale = Random.FRandRange(-0.5f, 0.5f);
+				Op.Offset = Random.FRandRange(-10.0f, 10.0f);
+			}
+		}
+
+		TArray<float> Values;
+		Values.SetNumZeroed(NumProperties);
+		FDynamicPropertiesBatchEvaluator::EvaluateStacks(BaseValues, Ops, OpStarts, OpCounts, Values);
+
+		for (int32 Property = 0; Property < NumProperties; ++Property)
+		{
+			float Expected = BaseValues[Property];
+			for (int32 Step = 0; Step < OpCounts[Property]; ++Step)
+			{
+				Expected = Ops[OpStarts[Property] + Step].Apply(BaseValues[Property], Expected);
+			}
+
+			if (!IsSameValue(Values[Property], Expected))
+			{
+				AddError(FString::Printf(TEXT("%d properties, property %d with %d ops: expected %.9g, got %.9g"), NumProperties, Property, OpCounts[Property], Expected, Values[Property]));
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertiesEvaluateAffineTest, "DynamicProperties.BatchEvaluator.EvaluateAffine", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertiesEvaluateAffineTest::RunTest(const FString& Parameters)
+{
+	using namespace DynamicPropertiesBatchEvaluatorTest;
+
+	FRandomStream Random(5678);
+
+	for (int32 NumProperties = 0; NumProperties <= 13; ++NumProperties)
+	{
+		const TArray<float> BaseValues = MakeBaseValues(NumProperties, Random);
+
+		TArray<float> Scales;
+		TArray<float> Offsets;
+		for (int32 Property = 0; Property < NumProperties; ++Property)
+		{
+			Scales.Add(Random.FRandRange(-2.0f, 2.0f));
+			Offsets.Add(Random.FRandRange(-100.0f, 100.0f));
+		}
+
+		TArray<float> Values;
+		Values.SetNumZeroed(NumProperties);
+		FDynamicPropertiesBatchEvaluator::EvaluateAffine(BaseValues, Scales, Offsets, Values);
+
+		for (int32 Property = 0; Property < NumProperties; ++Property)
+		{
+			// An affine form is a single op scaling the current value, applied to the base value
+			FModifierLinearOp Op;
+			Op.CurrentScale = Scales[Property];
+			Op.BaseScale = 0.0f;
+			Op.Offset = Offsets[Property];
+			const float Expected = Op.Apply(0.0f, BaseValues[Property]);
+
+			if (!IsSameValue(Values[Property], Expected))
+			{
+				AddError(FString::Printf(TEXT("%d properties, property %d: expected %.9g, got %.9g"), NumProperties, Property, Expected, Values[Property]));
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "GameplayTagContainer.h"
+#include "DynamicPropertiesBenchmarkListener.generated.h"
+
+/**
+ * Blueprint-style listener bound to container events by the DynamicProperties.Perf automation test
+ */
+UCLASS(Transient)
+class UDynamicPropertiesBenchmarkListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Number of events received */
+	int32 NumCalls = 0;
+
+	UFUNCTION()
+	void HandlePropertyValueChanged(FGameplayTag PropertyTag, float OldValue, float NewValue) { ++NumCalls; }
+};
@@ -0,0 +1,334 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DynamicPropertiesBenchmarkListener.h"
+#include "DynamicPropertiesContainer.h"
+#include "DynamicPropertiesTestsTags.h"
+#include "CascadeDynamicPropertiesContainer.h"
+#include "ModifierAdd.h"
+#include "ModifierScale.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+namespace DynamicPropertiesPerfTest
+{
+	/** One measured case */
+	struct FResult
+	{
+		FString Case;
+		int32 NumProperties = 0;
+		int32 TagDepth = 0;
+		int32 ModifiersPerProperty = 0;
+		int32 NumListeners = 0;
+		int64 NumOps = 0;
+		double NsPerOp = 0.0;
+
+		/** Growth of the process's used physical memory per op, not an allocation count */
+		double MemoryGrowthPerOp = 0.0;
+	};
+
+	/** Shared state of a benchmark run */
+	struct FRunner
+	{
+		explicit FRunner(FAutomationTestBase& InTest)
+			: Test(InTest)
+		{
+		}
+
+		FAutomationTestBase& Test;
+		int32 Iterations = 10;
+		TArray<FResult> Results;
+
+		/** Times Body over all iterations, Setup runs before each iteration outside of the measurement */
+		template <typename SetupType, typename BodyType>
+		void Measure(FResult Result, int64 OpsPerIteration, SetupType&& Setup, BodyType&& Body)
+		{
+			uint64 Cycles = 0;
+			int64 GrownBytes = 0;
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Setup();
+
+				// Process memory growth, the global allocator is left alone so allocations are not counted
+				// Other threads allocate too and the allocator keeps freed memory, so only large differences between runs mean anything
+				const int64 StartBytes = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+				Body();
+				Cycles += FPlatformTime::Cycles64() - StartCycles;
+				GrownBytes += static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - StartBytes;
+			}
+
+			Result.NumOps = OpsPerIteration * Iterations;
+			Result.NsPerOp = FPlatformTime::ToSeconds64(Cycles) * 1.0e9 / FMath::Max<int64>(Result.NumOps, 1);
+			Result.MemoryGrowthPerOp = static_cast<double>(GrownBytes) / FMath::Max<int64>(Result.NumOps, 1);
+			Results.Add(Result);
+
+			Test.AddInfo(FString::Printf(TEXT("%s P=%d D=%d M=%d L=%d: %.1f ns/op, %.1f bytes of memory growth/op"),
+				*Result.Case, Result.NumProperties, Result.TagDepth, Result.ModifiersPerProperty, Result.NumListeners, Result.NsPerOp, Result.MemoryGrowthPerOp));
+		}
+	};
+
+	/** Creates modifiers alternating between additive and multiplicative ones */
+	TArray<UModifier*> CreateModifiers(int32 Count)
+	{
+		TArray<UModifier*> Modifiers;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			UModifier* Modifier = nullptr;
+			if (Index % 2 == 0)
+			{
+				UModifierAdd* AddModifier = NewObject<UModifierAdd>(GetTransientPackage());
+				AddModifier->AdditiveValue = 1.0f;
+				Modifier = AddModifier;
+			}
+			else
+			{
+				UModifierScale* ScaleModifier = NewObject<UModifierScale>(GetTransientPackage());
+				ScaleModifier->Multiplier = 1.01f;
+				Modifier = ScaleModifier;
+			}
+			Modifier->Priority = Index % 4;
+			Modifier->AddToRoot();
+			Modifiers.Add(Modifier);
+		}
+		return Modifiers;
+	}
+
+	void ReleaseModifiers(const TArray<UModifier*>& Modifiers)
+	{
+		for (UModifier* Modifier : Modifiers)
+		{
+			Modifier->RemoveFromRoot();
+		}
+	}
+
+	void RunModifierCases(FRunner& Runner, const TArray<FGameplayTag>& AllTags, int32 NumProperties, int32 ModifiersPerProperty)
+	{
+		const TArray<UModifier*> Modifiers = CreateModifiers(ModifiersPerProperty);
+		UDynamicPropertiesContainer* Container = nullptr;
+		TArray<UDynamicProperty*> Properties;
+
+		auto CreateContainer = [&]()
+		{
+			if (Container)
+			{
+				Container->RemoveFromRoot();
+			}
+			Container = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+			Container->AddToRoot();
+			Properties.Reset();
+			for (int32 Index = 0; Index < NumProperties; ++Index)
+			{
+				Properties.Add(Container->GetOrAddProperty(AllTags[Index], 10.0f));
+			}
+		};
+
+		auto AddAll = [&]()
+		{
+			for (UDynamicProperty* Property : Properties)
+			{
+				for (UModifier* Modifier : Modifiers)
+				{
+					Property->AddModifier(Modifier);
+				}
+			}
+		};
+
+		FResult Result;
+		Result.NumProperties = NumProperties;
+		Result.ModifiersPerProperty = ModifiersPerProperty;
+		const int64 NumModifierOps = static_cast<int64>(NumProperties) * ModifiersPerProperty;
+
+		Result.Case = TEXT("AddModifier");
+		Runner.Measure(Result, NumModifierOps, CreateContainer, AddAll);
+
+		Result.Case = TEXT("RemoveModifier");
+		Runner.Measure(Result, NumModifierOps, [&]() { CreateContainer(); AddAll(); }, [&]()
+		{
+			for (UDynamicProperty* Property : Properties)
+			{
+				for (UModifier* Modifier : Modifiers)
+				{
+					Property->RemoveModifier(Modifier);
+				}
+			}
+		});
+
+		// Compact storage keeps every property's modifiers in shared arrays, interleaving properties exercises its range growth
+		TArray<FDynamicPropertyHandle> Handles;
+		auto CreateCompactContainer = [&]()
+		{
+			if (Container)
+			{
+				Container->RemoveFromRoot();
+			}
+			Container = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+			Container->AddToRoot();
+			Handles.Reset();
+			for (int32 Index = 0; Index < NumProperties; ++Index)
+			{
+				Handles.Add(Container->GetOrAddPropertyHandle(AllTags[Index], 10.0f));
+			}
+		};
+
+		auto AddAllCompact = [&]()
+		{
+			for (UModifier* Modifier : Modifiers)
+			{
+				for (const FDynamicPropertyHandle& Handle : Handles)
+				{
+					Container->AddPropertyModifierByHandle(Handle, Modifier);
+				}
+			}
+		};
+
+		Result.Case = TEXT("AddCompactModifier");
+		Runner.Measure(Result, NumModifierOps, CreateCompactContainer, AddAllCompact);
+
+		Result.Case = TEXT("RemoveCompactModifier");
+		Runner.Measure(Result, NumModifierOps, [&]() { CreateCompactContainer(); AddAllCompact(); }, [&]()
+		{
+			for (UModifier* Modifier : Modifiers)
+			{
+				for (const FDynamicPropertyHandle& Handle : Handles)
+				{
+					Container->RemovePropertyModifierByHandle(Handle, Modifier);
+				}
+			}
+		});
+
+		Result.Case = TEXT("Recalculate");
+		Runner.Measure(Result, NumProperties, [&]() { CreateContainer(); AddAll(); }, [&]()
+		{
+			for (UDynamicProperty* Property : Properties)
+			{
+				Property->Recalculate();
+			}
+		});
+
+		if (Container)
+		{
+			Container->RemoveFromRoot();
+		}
+		ReleaseModifiers(Modifiers);
+	}
+
+	void RunCascadeCase(FRunner& Runner, const TArray<FGameplayTag>& Chain, int32 NumListeners)
+	{
+		UCascadeDynamicPropertiesContainer* Container = NewObject<UCascadeDynamicPropertiesContainer>(GetTransientPackage());
+		Container->AddToRoot();
+		for (const FGameplayTag& Tag : Chain)
+		{
+			Container->AddProperty(Tag, 1.0f);
+		}
+
+		TArray<UDynamicPropertiesBenchmarkListener*> Listeners;
+		for (int32 Index = 0; Index < NumListeners; ++Index)
+		{
+			UDynamicPropertiesBenchmarkListener* Listener = NewObject<UDynamicPropertiesBenchmarkListener>(GetTransientPackage());
+			Listener->AddToRoot();
+			Container->OnPropertyValueChanged.AddDynamic(Listener, &UDynamicPropertiesBenchmarkListener::HandlePropertyValueChanged);
+			Listeners.Add(Listener);
+		}
+
+		constexpr int32 NumUpdates = 1000;
+		float NextValue = 2.0f;
+
+		FResult Result;
+		Result.Case = TEXT("CascadeUpdate");
+		Result.NumProperties = Chain.Num();
+		Result.TagDepth = Chain.Num();
+		Result.NumListeners = NumListeners;
+		Runner.Measure(Result, NumUpdates, []() {}, [&]()
+		{
+			// Each update of the root cascades down the whole chain
+			for (int32 Update = 0; Update < NumUpdates; ++Update)
+			{
+				Container->SetPropertyBaseValue(Chain[0], NextValue);
+				NextValue += 1.0f;
+			}
+		});
+
+		for (UDynamicPropertiesBenchmarkListener* Listener : Listeners)
+		{
+			Listener->RemoveFromRoot();
+		}
+		Container->RemoveFromRoot();
+	}
+
+	void WriteCsv(FAutomationTestBase& Test, const TArray<FResult>& Results)
+	{
+		FString Csv = TEXT("Case,NumProperties,TagDepth,ModifiersPerProperty,NumListeners,NumOps,NsPerOp,MemoryGrowthPerOp\n");
+		for (const FResult& Result : Results)
+		{
+			Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%lld,%.3f,%.4f\n"),
+				*Result.Case, Result.NumProperties, Result.TagDepth, Result.ModifiersPerProperty, Result.NumListeners, Result.NumOps, Result.NsPerOp, Result.MemoryGrowthPerOp);
+		}
+
+		const FString FilePath = FPaths::ProfilingDir() / TEXT("DynamicProperties") / FString::Printf(TEXT("Perf-%s.csv"), *FDateTime::Now().ToString());
+		if (FFileHelper::SaveStringToFile(Csv, *FilePath))
+		{
+			Test.AddInfo(FString::Printf(TEXT("Results written to %s"), *FilePath));
+		}
+	}
+
+	void Run(FAutomationTestBase& Test)
+	{
+		FRunner Runner(Test);
+		int32 Iterations = Runner.Iterations;
+		if (FParse::Value(FCommandLine::Get(), TEXT("DynamicPropertiesPerfIterations="), Iterations))
+		{
+			Runner.Iterations = FMath::Max(1, Iterations);
+		}
+
+		// Properties are keyed by the tags the tests module registers, which cover the whole sweep
+		const TArray<FGameplayTag> AllTags = DynamicPropertiesTestsTags::GetSomeTags(DynamicPropertiesTestsTags::NumPropertyTags);
+		const TArray<FGameplayTag> FullChain = DynamicPropertiesTestsTags::GetTagChain(DynamicPropertiesTestsTags::ChainDepth);
+		if (AllTags.Num() < DynamicPropertiesTestsTags::NumPropertyTags || FullChain.Num() < DynamicPropertiesTestsTags::ChainDepth)
+		{
+			Test.AddError(TEXT("The test gameplay tags are not registered."));
+			return;
+		}
+
+		for (const int32 NumProperties : { 1, 16, 256, 4096 })
+		{
+			for (const int32 ModifiersPerProperty : { 1, 4, 16, 64 })
+			{
+				RunModifierCases(Runner, AllTags, NumProperties, ModifiersPerProperty);
+			}
+		}
+
+		for (const int32 Depth : { 1, 2, 4, 8 })
+		{
+			const TArray<FGameplayTag> Chain = DynamicPropertiesTestsTags::GetTagChain(Depth);
+			for (const int32 NumListeners : { 0, 1, 8, 32 })
+			{
+				RunCascadeCase(Runner, Chain, NumListeners);
+			}
+		}
+
+		WriteCsv(Test, Runner.Results);
+	}
+}
+
+/**
+ * Benchmarks AddModifier, RemoveModifier, their compact storage counterparts, Recalculate and cascade updates over sweeps of property count, modifiers per property,
+ * tag depth and listeners, and writes ns/op and process memory growth per op to Saved/Profiling/DynamicProperties
+ * Run with Automation RunTests DynamicProperties.Perf, -DynamicPropertiesPerfIterations=N sets the iterations per case
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertiesPerfTest, "DynamicProperties.Perf", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FDynamicPropertiesPerfTest::RunTest(const FString& Parameters)
+{
+	DynamicPropertiesPerfTest::Run(*this);
+	return true;
+}
+
+#endif
@@ -0,0 +1,136 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DynamicPropertiesReplication.h"
+#include "DynamicPropertiesTestsTags.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+namespace DynamicPropertiesReplicationTest
+{
+	/** Equal values, or NaN on both sides */
+	bool IsSameValue(float A, float B)
+	{
+		return A == B || (FMath::IsNaN(A) && FMath::IsNaN(B));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertiesReplicationRoundTripTest, "DynamicProperties.Replication.RoundTrip", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertiesReplicationRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace DynamicPropertiesReplicationTest;
+
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(1);
+	if (Tags.Num() < 1)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+	const FGameplayTag Tag = Tags[0];
+
+	const EDynamicPropertyQuantization Modes[] = { EDynamicPropertyQuantization::None, EDynamicPropertyQuantization::Hundredths, EDynamicPropertyQuantization::Tenths, EDynamicPropertyQuantization::Integer };
+
+	// Ordinary values, values at and past the quantized range, and non-finite ones
+	const float Values[] = { 0.0f, -0.0f, 1.0f, -1.0f, 12.345f, -12.345f, 0.004f, 0.05f, 0.5f, 1234.567f, 2.0e5f, -2.2e5f, 1.0e7f, 2.2e7f, -3.0e9f,
+		TNumericLimits<float>::Max(), -TNumericLimits<float>::Max(), INFINITY, -INFINITY, NAN };
+
+	for (const EDynamicPropertyQuantization Mode : Modes)
+	{
+		for (const float Value : Values)
+		{
+			FDynamicPropertyReplicatedItem Sent;
+			Sent.PropertyTag = Tag;
+			Sent.Value = Value;
+			Sent.Quantization = Mode;
+
+			FBitWriter Writer(0, true);
+			bool bSaved = false;
+			Sent.NetSerialize(Writer, nullptr, bSaved);
+
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			FDynamicPropertyReplicatedItem Received;
+			bool bLoaded = false;
+			Received.NetSerialize(Reader, nullptr, bLoaded);
+
+			const float Expected = FDynamicPropertyReplicatedItem::Quantize(Value, Mode);
+			if (!bSaved || !bLoaded || Reader.IsError() || Reader.GetBitsLeft() != 0)
+			{
+				AddError(FString::Printf(TEXT("Mode %d, value %g: serialization failed."), static_cast<int32>(Mode), Value));
+			}
+			else if (!IsSameValue(Received.Value, Expected))
+			{
+				AddError(FString::Printf(TEXT("Mode %d, value %g: received %g, expected %g."), static_cast<int32>(Mode), Value, Received.Value, Expected));
+			}
+			else if (Received.PropertyTag != Tag)
+			{
+				AddError(FString::Printf(TEXT("Mode %d, value %g: received tag %s, expected %s."), static_cast<int32>(Mode), Value, *Received.PropertyTag.ToString(), *Tag.ToString()));
+			}
+
+			// Values that fit are within half a step of the original, the rest are sent exactly
+			if (FMath::IsFinite(Value) && FMath::Abs(Received.Value - Value) > FMath::Max(1.0f, FMath::Abs(Value)) * 0.5f)
+			{
+				AddError(FString::Printf(TEXT("Mode %d, value %g: received %g, the quantized value overflowed."), static_cast<int32>(Mode), Value, Received.Value));
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertiesReplicationDeltaTest, "DynamicProperties.Replication.Delta", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertiesReplicationDeltaTest::RunTest(const FString& Parameters)
+{
+	using namespace DynamicPropertiesReplicationTest;
+
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(3);
+	if (Tags.Num() < 3)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	FDynamicPropertiesReplicatedValues Values;
+	for (const FGameplayTag& Tag : Tags)
+	{
+		TestTrue(TEXT("New items are dirty"), Values.SetValue(Tag, 10.0f, EDynamicPropertyQuantization::Tenths));
+	}
+
+	// Fast array delta serialization sends exactly the items whose replication key changed since the last send
+	auto GetKeys = [&Values]()
+	{
+		TArray<int32> Keys;
+		for (const FDynamicPropertyReplicatedItem& Item : Values.GetItems())
+		{
+			Keys.Add(Item.ReplicationKey);
+		}
+		return Keys;
+	};
+
+	const TArray<int32> KeysBefore = GetKeys();
+	const int32 ArrayKeyBefore = Values.ArrayReplicationKey;
+
+	TestFalse(TEXT("A change below the sent precision isn't dirty"), Values.SetValue(Tags[0], 10.01f, EDynamicPropertyQuantization::Tenths));
+	TestTrue(TEXT("A change above the sent precision is dirty"), Values.SetValue(Tags[1], 10.2f, EDynamicPropertyQuantization::Tenths));
+	TestFalse(TEXT("Setting the same value isn't dirty"), Values.SetValue(Tags[2], 10.0f, EDynamicPropertyQuantization::Tenths));
+
+	const TArray<int32> KeysAfter = GetKeys();
+	TestEqual(TEXT("Item count"), KeysAfter.Num(), KeysBefore.Num());
+	TestEqual(TEXT("Unchanged item is not sent"), KeysAfter[0], KeysBefore[0]);
+	TestNotEqual(TEXT("Changed item is sent"), KeysAfter[1], KeysBefore[1]);
+	TestEqual(TEXT("Unchanged item is not sent"), KeysAfter[2], KeysBefore[2]);
+	TestNotEqual(TEXT("Array is sent"), Values.ArrayReplicationKey, ArrayKeyBefore);
+
+	// A large value falls back to full precision, so every change to it is sent
+	TestTrue(TEXT("Large value is dirty"), Values.SetValue(Tags[2], 3.0e9f, EDynamicPropertyQuantization::Tenths));
+	TestTrue(TEXT("Small change to a large value is dirty"), Values.SetValue(Tags[2], 3.0e9f + 256.0f, EDynamicPropertyQuantization::Tenths));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,141 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DynamicPropertiesContainer.h"
+#include "DynamicPropertiesSnapshot.h"
+#include "DynamicPropertiesTestsTags.h"
+#include "Misc/AutomationTest.h"
+#include "ModifierAdd.h"
+#include "ModifierExpression.h"
+#include "SharedModifier.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertiesSnapshotInvalidTest, "DynamicProperties.Snapshot.InvalidData", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertiesSnapshotInvalidTest::RunTest(const FString& Parameters)
+{
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(1);
+	if (Tags.Num() < 1)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	UDynamicPropertiesContainer* Source = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+	Source->GetOrAddPropertyHandle(Tags[0], 1.0f);
+	UModifierAdd* Add = NewObject<UModifierAdd>(Source);
+	Add->AdditiveValue = 2.0f;
+	Source->AddPropertyModifier(Tags[0], Add);
+
+	TArray<uint8> Data;
+	FDynamicPropertiesSnapshot::Save(*Source, Data);
+
+	UDynamicPropertiesContainer* Target = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+	Target->GetOrAddPropertyHandle(Tags[0], 5.0f);
+
+	// Every truncation fails, leaves the container untouched and creates no modifier objects
+	for (int32 Size = 0; Size < Data.Num(); ++Size)
+	{
+		const TArray<uint8> Truncated(Data.GetData(), Size);
+		TestFalse(TEXT("Truncated snapshot is rejected"), FDynamicPropertiesSnapshot::Load(*Target, Truncated));
+
+		TArray<UObject*> Created;
+		GetObjectsWithOuter(Target, Created, false);
+		if (Created.ContainsByPredicate([](const UObject* Object) { return Object->IsA<UModifier>(); }))
+		{
+			AddError(FString::Printf(TEXT("Loading %d of %d bytes created modifier objects."), Size, Data.Num()));
+			break;
+		}
+	}
+	TestEqual(TEXT("Container untouched"), Target->GetPropertyValueOrDefault(Tags[0], 0.0f), 5.0f);
+
+	TestTrue(TEXT("Full snapshot loads"), FDynamicPropertiesSnapshot::Load(*Target, Data));
+	TestEqual(TEXT("Loaded value"), Target->GetPropertyValueOrDefault(Tags[0], 0.0f), 3.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertiesSnapshotSharedModifierTest, "DynamicProperties.Snapshot.SharedModifier", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertiesSnapshotSharedModifierTest::RunTest(const FString& Parameters)
+{
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(1);
+	if (Tags.Num() < 1)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	USharedModifier* Shared = NewObject<USharedModifier>(GetTransientPackage());
+	UModifierAdd* Add = NewObject<UModifierAdd>(Shared);
+	Add->AdditiveValue = 2.0f;
+	Shared->SetModifier(Add);
+
+	UDynamicPropertiesContainer* Container = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+	Container->GetOrAddPropertyHandle(Tags[0], 1.0f);
+	Container->SubscribeToSharedModifier(Tags[0], Shared);
+
+	TArray<uint8> Data;
+	FDynamicPropertiesSnapshot::Save(*Container, Data);
+	TestTrue(TEXT("Snapshot loads"), FDynamicPropertiesSnapshot::Load(*Container, Data));
+
+	// The restored property subscribes to the same shared modifier instead of holding a copy
+	TestEqual(TEXT("Subscriptions after restoring"), Shared->GetNumSubscribers(), 1);
+	TestEqual(TEXT("Restored value"), Container->GetPropertyValueOrDefault(Tags[0], 0.0f), 3.0f);
+
+	UModifierAdd* Replacement = NewObject<UModifierAdd>(Shared);
+	Replacement->AdditiveValue = 10.0f;
+	Shared->SetModifier(Replacement);
+	TestEqual(TEXT("Value follows the shared modifier"), Container->GetPropertyValueOrDefault(Tags[0], 0.0f), 11.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertiesSnapshotRestoreTest, "DynamicProperties.Snapshot.Restore", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertiesSnapshotRestoreTest::RunTest(const FString& Parameters)
+{
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(2);
+	if (Tags.Num() < 2)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	// The property reading another one is saved before its input
+	UDynamicPropertiesContainer* Source = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+	Source->GetOrAddPropertyHandle(Tags[1], 0.0f);
+	UModifierExpression* Expression = NewObject<UModifierExpression>(Source);
+	Expression->SetExpression(FString::Printf(TEXT("[%s] * 2"), *Tags[0].ToString()));
+	Source->AddPropertyModifier(Tags[1], Expression);
+	Source->GetOrAddPropertyHandle(Tags[0], 4.0f);
+
+	UObject* Buff = NewObject<UObject>(GetTransientPackage());
+	UModifierAdd* Add = NewObject<UModifierAdd>(Source);
+	Add->AdditiveValue = 1.0f;
+	Source->GetProperty(Tags[0])->AddModifier(Add, Buff);
+	TestEqual(TEXT("Saved value"), Source->GetPropertyValueOrDefault(Tags[1], 0.0f), 10.0f);
+
+	TArray<uint8> Data;
+	FDynamicPropertiesSnapshot::Save(*Source, Data);
+
+	UDynamicPropertiesContainer* Target = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+	TestTrue(TEXT("Snapshot loads"), FDynamicPropertiesSnapshot::Load(*Target, Data));
+
+	// Inputs are calculated before the properties reading them
+	TestEqual(TEXT("Restored input"), Target->GetPropertyValueOrDefault(Tags[0], 0.0f), 5.0f);
+	TestEqual(TEXT("Restored dependent"), Target->GetPropertyValueOrDefault(Tags[1], 0.0f), 10.0f);
+
+	// Restored modifiers keep their source
+	TestEqual(TEXT("Modifiers removed by source"), Target->RemoveModifiersBySource(Buff), 1);
+	TestEqual(TEXT("Input without the source's modifier"), Target->GetPropertyValueOrDefault(Tags[0], 0.0f), 4.0f);
+	TestEqual(TEXT("Dependent follows its input"), Target->GetPropertyValueOrDefault(Tags[1], 0.0f), 8.0f);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,19 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModifierAdd.h"
+#include "DynamicPropertiesTestModifiers.generated.h"
+
+/**
+ * Native subclass of a linear modifier that changes Apply without declaring its own linear form
+ */
+UCLASS(Transient)
+class UDynamicPropertiesTestModifierAddTwice : public UModifierAdd
+{
+	GENERATED_BODY()
+
+public:
+	virtual float Apply_Implementation(float BaseValue, float CurrentValue) override { return CurrentValue + 2.0f * AdditiveValue; }
+};
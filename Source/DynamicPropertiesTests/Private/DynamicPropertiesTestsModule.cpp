@@ -0,0 +1,30 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Modules/ModuleManager.h"
+#include "DynamicPropertiesTestsTags.h"
+#include "GameplayTagsManager.h"
+
+class FDynamicPropertiesTestsModule : public IModuleInterface
+{
+public:
+	virtual void StartupModule() override
+	{
+		// Tests key their properties by tags of their own instead of whatever the project registers
+		UGameplayTagsManager::OnLastChanceToAddNativeTags().AddStatic(&FDynamicPropertiesTestsModule::AddNativeTags);
+	}
+
+private:
+	static void AddNativeTags()
+	{
+		UGameplayTagsManager& TagsManager = UGameplayTagsManager::Get();
+		for (int32 Index = 0; Index < DynamicPropertiesTestsTags::NumPropertyTags; ++Index)
+		{
+			TagsManager.AddNativeGameplayTag(DynamicPropertiesTestsTags::GetPropertyTagName(Index), TEXT("DynamicProperties automation tests"));
+		}
+
+		// Parents of the deepest tag are registered implicitly
+		TagsManager.AddNativeGameplayTag(DynamicPropertiesTestsTags::GetChainTagName(), TEXT("DynamicProperties automation tests"));
+	}
+};
+
+IMPLEMENT_MODULE(FDynamicPropertiesTestsModule, DynamicPropertiesTests)
@@ -0,0 +1,62 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+namespace DynamicPropertiesTestsTags
+{
+	/** Number of property tags registered for the tests, as many as the largest perf sweep uses */
+	constexpr int32 NumPropertyTags = 4096;
+
+	/** Depth of the registered tag chain, the deepest cascade the perf sweep measures */
+	constexpr int32 ChainDepth = 8;
+
+	/** Gets the name of a test property tag, all of them are siblings */
+	inline FName GetPropertyTagName(int32 Index)
+	{
+		return FName(*FString::Printf(TEXT("DynamicPropertiesTests.Property.%d"), Index));
+	}
+
+	/** Gets the name of the deepest tag of the test chain, its parents make up the rest of the chain */
+	inline FName GetChainTagName()
+	{
+		return FName(TEXT("DynamicPropertiesTests.Chain.Level3.Level4.Level5.Level6.Level7.Level8"));
+	}
+
+	/**
+	 * Gets the first MaxTags test property tags, registered as native tags by the tests module
+	 * Fewer are returned only if the module was loaded too late to register them, tests fail in that case
+	 */
+	inline TArray<FGameplayTag> GetSomeTags(int32 MaxTags)
+	{
+		TArray<FGameplayTag> Tags;
+		for (int32 Index = 0; Index < FMath::Min(MaxTags, NumPropertyTags); ++Index)
+		{
+			const FGameplayTag Tag = FGameplayTag::RequestGameplayTag(GetPropertyTagName(Index), false);
+			if (!Tag.IsValid())
+			{
+				break;
+			}
+			Tags.Add(Tag);
+		}
+		return Tags;
+	}
+
+	/** Gets the test tag chain from its root down, at most Depth tags long */
+	inline TArray<FGameplayTag> GetTagChain(int32 Depth)
+	{
+		TArray<FGameplayTag> Chain;
+		for (FGameplayTag Current = FGameplayTag::RequestGameplayTag(GetChainTagName(), false); Current.IsValid(); Current = Current.RequestDirectParent())
+		{
+			Chain.Insert(Current, 0);
+		}
+
+		if (Chain.Num() > Depth)
+		{
+			Chain.SetNum(Depth);
+		}
+		return Chain;
+	}
+}
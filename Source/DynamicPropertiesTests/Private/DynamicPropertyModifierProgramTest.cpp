@@ -0,0 +1,54 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DynamicPropertiesTestModifiers.h"
+#include "DynamicProperty.h"
+#include "Misc/AutomationTest.h"
+#include "ModifierAdd.h"
+#include "ModifierScale.h"
+#include "UObject/Package.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertyModifierProgramTest, "DynamicProperties.Property.ModifierProgram", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertyModifierProgramTest::RunTest(const FString& Parameters)
+{
+	UDynamicProperty* Property = NewObject<UDynamicProperty>(GetTransientPackage());
+	Property->SetBaseValue(10.0f);
+
+	UModifierAdd* Add = NewObject<UModifierAdd>(GetTransientPackage());
+	Add->AdditiveValue = 5.0f;
+	UModifierScale* Scale = NewObject<UModifierScale>(GetTransientPackage());
+	Scale->Multiplier = 2.0f;
+	Scale->Priority = 1;
+
+	const FModifierHandle AddHandle = Property->AddModifier(Add);
+	Property->AddModifier(Scale);
+	TestEqual(TEXT("Compiled value"), Property->GetValue(), 30.0f);
+
+	// Parameters written after the program was compiled are picked up once the modifier is updated
+	Add->AdditiveValue = 1.0f;
+	TestTrue(TEXT("Modifier updated"), Property->UpdateModifier(AddHandle));
+	TestEqual(TEXT("Value after updating a modifier"), Property->GetValue(), 22.0f);
+
+	Scale->Multiplier = 3.0f;
+	Property->RefreshModifiers();
+	TestEqual(TEXT("Value after refreshing the modifiers"), Property->GetValue(), 33.0f);
+
+	// The inherited linear form doesn't describe a native subclass's own Apply
+	UDynamicPropertiesTestModifierAddTwice* AddTwice = NewObject<UDynamicPropertiesTestModifierAddTwice>(GetTransientPackage());
+	AddTwice->AdditiveValue = 1.0f;
+	FModifierLinearOp Op;
+	TestFalse(TEXT("Subclass overriding Apply is not linear"), AddTwice->GetLinearOp(Op));
+	TestTrue(TEXT("Built-in modifier is linear"), Add->GetLinearOp(Op));
+
+	Property->RemoveModifier(Scale);
+	Property->AddModifier(AddTwice);
+	TestEqual(TEXT("Value with the subclass"), Property->GetValue(), 13.0f);
+
+	return true;
+}
+
+#endif
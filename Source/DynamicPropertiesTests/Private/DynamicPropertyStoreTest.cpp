@@ -0,0 +1,183 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DynamicPropertiesTestsTags.h"
+#include "DynamicPropertyStore.h"
+#include "Misc/AutomationTest.h"
+#include "ModifierAdd.h"
+#include "UObject/Package.h"
+
+namespace DynamicPropertyStoreTest
+{
+	UModifierAdd* MakeAdd(float AdditiveValue, int32 Priority)
+	{
+		UModifierAdd* Modifier = NewObject<UModifierAdd>(GetTransientPackage());
+		Modifier->AdditiveValue = AdditiveValue;
+		Modifier->Priority = Priority;
+		return Modifier;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertyStoreModifierRangesTest, "DynamicProperties.Store.ModifierRanges", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertyStoreModifierRangesTest::RunTest(const FString& Parameters)
+{
+	using namespace DynamicPropertyStoreTest;
+
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(2);
+	if (Tags.Num() < 2)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	FDynamicPropertyStore Store;
+	const int32 X = Store.Add(Tags[0], 0.0f).Index;
+	const int32 Y = Store.Add(Tags[1], 0.0f).Index;
+
+	UModifierAdd* YFirst = MakeAdd(1000.0f, 0);
+	UModifierAdd* XFirst = MakeAdd(1.0f, 0);
+	UModifierAdd* XLowPriority = MakeAdd(10.0f, -1);
+	UModifierAdd* YSecond = MakeAdd(100.0f, 0);
+
+	// Leaves Y's empty range at the start of X's range, the lower priority insertion into X must not move it inside X
+	Store.AddModifier(Y, YFirst);
+	Store.AddModifier(X, XFirst);
+	Store.RemoveModifier(Y, YFirst);
+	Store.AddModifier(X, XLowPriority);
+	Store.AddModifier(Y, YSecond);
+
+	TArray<UModifier*> XModifiers;
+	TArray<UModifier*> YModifiers;
+	Store.GetModifiers(X, XModifiers);
+	Store.GetModifiers(Y, YModifiers);
+
+	TestTrue(TEXT("X modifiers"), XModifiers == TArray<UModifier*>({ XLowPriority, XFirst }));
+	TestTrue(TEXT("Y modifiers"), YModifiers == TArray<UModifier*>({ YSecond }));
+
+	float OldValue = 0.0f;
+	Store.Recalculate(X, OldValue);
+	Store.Recalculate(Y, OldValue);
+	TestEqual(TEXT("X value"), Store.GetValue(X), 11.0f);
+	TestEqual(TEXT("Y value"), Store.GetValue(Y), 100.0f);
+
+	// The batch kernel reads the same ranges
+	TArray<int32> ChangedIndices;
+	TArray<float> OldValues;
+	Store.SetBaseValue(X, 1.0f);
+	Store.RecalculateAll(ChangedIndices, OldValues);
+	TestEqual(TEXT("X value after batch"), Store.GetValue(X), 12.0f);
+	TestEqual(TEXT("Y value after batch"), Store.GetValue(Y), 100.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertyStoreHandleTest, "DynamicProperties.Store.Handles", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertyStoreHandleTest::RunTest(const FString& Parameters)
+{
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(3);
+	if (Tags.Num() < 3)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	FDynamicPropertyStore Store;
+	const FDynamicPropertyHandle First = Store.Add(Tags[0], 1.0f);
+	const FDynamicPropertyHandle Second = Store.Add(Tags[1], 2.0f);
+	const FDynamicPropertyHandle Last = Store.Add(Tags[2], 3.0f);
+
+	// The last property is moved into the removed one's slot
+	Store.Remove(Tags[0]);
+
+	TestEqual(TEXT("Removed property doesn't resolve"), Store.Resolve(First), INDEX_NONE);
+	TestEqual(TEXT("Untouched property resolves in place"), Store.Resolve(Second), Second.Index);
+	TestEqual(TEXT("Moved property resolves through its tag"), Store.Resolve(Last), First.Index);
+	TestEqual(TEXT("Moved property value"), Store.GetBaseValue(Store.Resolve(Last)), 3.0f);
+	TestEqual(TEXT("Invalid handle doesn't resolve"), Store.Resolve(FDynamicPropertyHandle()), INDEX_NONE);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDynamicPropertyStoreModifierSlackTest, "DynamicProperties.Store.ModifierSlack", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDynamicPropertyStoreModifierSlackTest::RunTest(const FString& Parameters)
+{
+	using namespace DynamicPropertyStoreTest;
+
+	constexpr int32 NumProperties = 16;
+	constexpr int32 NumModifiers = 20;
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(NumProperties);
+	if (Tags.Num() < NumProperties)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	TArray<UModifierAdd*> Modifiers;
+	for (int32 ModifierIndex = 0; ModifierIndex < NumModifiers; ++ModifierIndex)
+	{
+		Modifiers.Add(MakeAdd(static_cast<float>(1 << (ModifierIndex % 8)), -ModifierIndex));
+	}
+
+	FDynamicPropertyStore Store;
+	for (const FGameplayTag& Tag : Tags)
+	{
+		Store.Add(Tag, 0.0f);
+	}
+
+	// Interleaved insertions outgrow every range several times, moving them and packing the holes they leave
+	for (UModifierAdd* Modifier : Modifiers)
+	{
+		for (int32 Index = 0; Index < NumProperties; ++Index)
+		{
+			Store.AddModifier(Index, Modifier);
+		}
+	}
+
+	// Every other modifier is removed again, and the first half of the properties with them
+	for (int32 ModifierIndex = 0; ModifierIndex < NumModifiers; ModifierIndex += 2)
+	{
+		for (int32 Index = 0; Index < NumProperties; ++Index)
+		{
+			Store.RemoveModifier(Index, Modifiers[ModifierIndex]);
+		}
+	}
+	for (int32 TagIndex = 0; TagIndex < NumProperties / 2; ++TagIndex)
+	{
+		Store.Remove(Tags[TagIndex]);
+	}
+
+	// Lower priority values come first, so the remaining modifiers are applied in reverse
+	TArray<UModifier*> Expected;
+	float ExpectedValue = 0.0f;
+	for (int32 ModifierIndex = NumModifiers - 1; ModifierIndex >= 0; --ModifierIndex)
+	{
+		if (ModifierIndex % 2 == 1)
+		{
+			Expected.Add(Modifiers[ModifierIndex]);
+			ExpectedValue += Modifiers[ModifierIndex]->AdditiveValue;
+		}
+	}
+
+	TArray<int32> ChangedIndices;
+	TArray<float> OldValues;
+	Store.RecalculateAll(ChangedIndices, OldValues);
+
+	TestEqual(TEXT("Remaining properties"), Store.Num(), NumProperties / 2);
+	TArray<UModifier*> PropertyModifiers;
+	for (int32 Index = 0; Index < Store.Num(); ++Index)
+	{
+		Store.GetModifiers(Index, PropertyModifiers);
+		TestTrue(FString::Printf(TEXT("Modifiers of %s"), *Store.GetTag(Index).ToString()), PropertyModifiers == Expected);
+		TestEqual(FString::Printf(TEXT("Value of %s"), *Store.GetTag(Index).ToString()), Store.GetValue(Index), ExpectedValue);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,69 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DynamicPropertiesContainer.h"
+#include "DynamicPropertiesTestsTags.h"
+#include "Misc/AutomationTest.h"
+#include "ModifierExpression.h"
+#include "UObject/Package.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModifierExpressionContainerTest, "DynamicProperties.ModifierExpression.EvaluatingContainer", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FModifierExpressionContainerTest::RunTest(const FString& Parameters)
+{
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(3);
+	if (Tags.Num() < 3)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	UDynamicPropertiesContainer* First = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+	UDynamicPropertiesContainer* Second = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+	First->GetOrAddPropertyHandle(Tags[0], 5.0f);
+	Second->GetOrAddPropertyHandle(Tags[0], 7.0f);
+	First->GetOrAddPropertyHandle(Tags[1], 1.0f);
+	Second->GetOrAddProperty(Tags[2], 1.0f);
+
+	// A modifier created outside any container, applied to a compact property of one and a property object of another
+	UModifierExpression* Expression = NewObject<UModifierExpression>(GetTransientPackage());
+	Expression->SetExpression(FString::Printf(TEXT("Current + [%s]"), *Tags[0].ToString()));
+	TestTrue(TEXT("Expression compiled"), Expression->GetCompileError().IsEmpty());
+
+	First->AddPropertyModifier(Tags[1], Expression);
+	Second->AddPropertyModifier(Tags[2], Expression);
+	TestEqual(TEXT("Compact property reads its container"), First->GetPropertyValueOrDefault(Tags[1], 0.0f), 6.0f);
+	TestEqual(TEXT("Property object reads its container"), Second->GetPropertyValueOrDefault(Tags[2], 0.0f), 8.0f);
+
+	// The value read agrees with the dependency that recalculates it
+	First->SetPropertyBaseValue(Tags[0], 10.0f);
+	Second->SetPropertyBaseValue(Tags[0], 20.0f);
+	TestEqual(TEXT("Compact property follows its input"), First->GetPropertyValueOrDefault(Tags[1], 0.0f), 11.0f);
+	TestEqual(TEXT("Property object follows its input"), Second->GetPropertyValueOrDefault(Tags[2], 0.0f), 21.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModifierExpressionNestingTest, "DynamicProperties.ModifierExpression.Nesting", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FModifierExpressionNestingTest::RunTest(const FString& Parameters)
+{
+	UModifierExpression* Expression = NewObject<UModifierExpression>(GetTransientPackage());
+
+	// Parentheses and signs take no registers, they are bounded by the nesting limit instead
+	const int32 Allowed = UModifierExpression::MaxNesting;
+	TestTrue(TEXT("Parentheses up to the limit compile"), Expression->SetExpression(FString::ChrN(Allowed, TEXT('(')) + TEXT("1") + FString::ChrN(Allowed, TEXT(')'))));
+	TestTrue(TEXT("Signs up to the limit compile"), Expression->SetExpression(FString::ChrN(Allowed, TEXT('-')) + TEXT("1")));
+
+	const int32 Excessive = 100000;
+	TestFalse(TEXT("Deep parentheses are rejected"), Expression->SetExpression(FString::ChrN(Excessive, TEXT('(')) + TEXT("1") + FString::ChrN(Excessive, TEXT(')'))));
+	TestFalse(TEXT("Chained signs are rejected"), Expression->SetExpression(FString::ChrN(Excessive, TEXT('-')) + TEXT("1")));
+	TestFalse(TEXT("Rejected expression reports an error"), Expression->GetCompileError().IsEmpty());
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DynamicPropertiesContainer.h"
+#include "DynamicPropertiesTestsTags.h"
+#include "Misc/AutomationTest.h"
+#include "ModifierAdd.h"
+#include "SharedModifier.h"
+#include "UObject/Package.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSharedModifierSubscriptionsTest, "DynamicProperties.SharedModifier.Subscriptions", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSharedModifierSubscriptionsTest::RunTest(const FString& Parameters)
+{
+	const TArray<FGameplayTag> Tags = DynamicPropertiesTestsTags::GetSomeTags(2);
+	if (Tags.Num() < 2)
+	{
+		AddError(TEXT("The test gameplay tags are not registered."));
+		return false;
+	}
+
+	USharedModifier* Shared = NewObject<USharedModifier>(GetTransientPackage());
+	UModifierAdd* Add = NewObject<UModifierAdd>(Shared);
+	Add->AdditiveValue = 2.0f;
+	Shared->SetModifier(Add);
+
+	// One compact property and one property object
+	UDynamicPropertiesContainer* Container = NewObject<UDynamicPropertiesContainer>(GetTransientPackage());
+	Container->GetOrAddPropertyHandle(Tags[0], 1.0f);
+	Container->GetOrAddProperty(Tags[1], 1.0f);
+
+	for (const FGameplayTag& Tag : Tags)
+	{
+		Container->SubscribeToSharedModifier(Tag, Shared);
+	}
+	TestEqual(TEXT("Subscriptions"), Shared->GetNumSubscribers(), 2);
+
+	// Removing the modifier directly ends the subscription
+	Container->RemovePropertyModifier(Tags[0], Shared);
+	Container->RemovePropertyModifier(Tags[1], Shared);
+	TestEqual(TEXT("Subscriptions after removing the modifiers"), Shared->GetNumSubscribers(), 0);
+
+	Container->SubscribeToSharedModifier(Tags[0], Shared);
+	Container->UnsubscribeFromSharedModifier(Tags[0], Shared);
+	TestEqual(TEXT("Subscriptions after unsubscribing"), Shared->GetNumSubscribers(), 0);
+
+	// Removed properties stop following the shared modifier
+	for (const FGameplayTag& Tag : Tags)
+	{
+		Container->SubscribeToSharedModifier(Tag, Shared);
+		Container->RemoveProperty(Tag);
+	}
+	TestEqual(TEXT("Subscriptions after removing the properties"), Shared->GetNumSubscribers(), 0);
+
+	UModifierAdd* Replacement = NewObject<UModifierAdd>(Shared);
+	Replacement->AdditiveValue = 10.0f;
+	Shared->SetModifier(Replacement);
+	TestFalse(TEXT("Removed property stays removed"), Container->HasProperty(Tags[0]));
+
+	return true;
+}
+
+#endif